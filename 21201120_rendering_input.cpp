@@ -2,10 +2,28 @@
 # ├─ include/
 # │  ├─ state.hpp
 # │  ├─ render.hpp
-# │  └─ input.hpp
+# │  ├─ input.hpp
+# │  ├─ glbuf.hpp
+# │  ├─ sprites.hpp
+# │  ├─ font5x7.hpp
+# │  ├─ glyphatlas.hpp
+# │  ├─ softraster.hpp
+# │  ├─ simthread.hpp
+# │  ├─ redraw.hpp
+# │  └─ bigview.hpp
 # ├─ src/
 # │  ├─ render.cpp
 # │  ├─ input.cpp
+# │  ├─ glbuf.cpp
+# │  ├─ sprites.cpp
+# │  ├─ font5x7.cpp
+# │  ├─ glyphatlas.cpp
+# │  ├─ softraster.cpp
+# │  ├─ thumbs.cpp
+# │  ├─ bench.cpp
+# │  ├─ simthread.cpp
+# │  ├─ redraw.cpp
+# │  ├─ bigview.cpp
 # │  └─ main.cpp
 # ├─ CMakeLists.txt
 # ├─ .gitignore
@@ -28,12 +46,18 @@ extern int hoverPlay, hoverExit;                 // main menu
 extern int hoverPG_PlayAgain, hoverPG_Quit;      // post-game menu
 extern int hoverQC_PlayAgain, hoverQC_Quit;      // quit confirm menu (Yes/No)
 
+// Debug overlays
+extern bool showProfiler;                        // F3: frame-time overlay
+
 
 // =====================================
 // File: include/render.hpp
 // =====================================
 #pragma once
 
+// One-time GL setup (buffers for the static maze); call after the window exists
+void initRenderer();
+
 // Router for display based on gState
 void renderDisplay();
 
@@ -46,6 +70,7 @@ void renderGame();
 void renderPostGameMenu();
 void renderQuitConfirmMenu();
 void renderGameOverOverlay();
+void renderProfilerOverlay();
 
 
 // =====================================
@@ -60,174 +85,404 @@ void onMouseClick(int button,int state,int x,int y);
 void onPassiveMotion(int x,int y);
 
 
+// =====================================
+// File: include/glbuf.hpp
+// =====================================
+#pragma once
+#include <GL/glut.h>
+#include <vector>
+
+// Retained 2D vertex storage (x,y float pairs). Lives in a GL 1.5 buffer
+// object when the driver exposes one, otherwise in a client-side array;
+// drawing code is identical either way.
+struct VertexBuffer {
+  GLuint id = 0;             // 0 => client-array fallback
+  std::vector<float> cpu;    // fallback storage (unused when id != 0)
+  int count = 0;             // vertices uploaded
+  int capacity = 0;          // vertices the storage can hold
+};
+
+// Resolve buffer-object entry points; call once after the GL context exists
+bool glbufInit();
+bool glbufHasVBO();
+
+// (Re)define the contents; dynamic=true hints at frequent glbufUpdate calls
+void glbufUpload(VertexBuffer& vb, const float* xy, int nVerts, bool dynamic=false);
+// Overwrite vertices [first, first+nVerts) in place (must fit the capacity)
+void glbufUpdate(VertexBuffer& vb, int first, const float* xy, int nVerts);
+// Draw [first, first+n) with the current color; enables/disables the vertex array itself
+void glbufDraw(const VertexBuffer& vb, GLenum mode, int first, int n);
+// For many draws from one buffer: bind once, glDrawArrays freely, then unbind
+void glbufBind(const VertexBuffer& vb);
+void glbufUnbind();
+
+// Sync buffer swaps to the display refresh (interval 1) through the platform
+// swap-control extension (GLX EXT, MESA or SGI, or WGL EXT); false if it
+// refused, or if none was found, which is logged to stderr
+bool glSetSwapInterval(int interval);
+
+
+// =====================================
+// File: include/sprites.hpp
+// =====================================
+#pragma once
+#include <vector>
+#include "../your-part/include/types.hpp"
+
+// Sprites tessellated once into plain triangle lists in sprite-local units
+// (origin at the sprite center). GL-free, so any backend can draw them.
+struct MeshPart { pac::RGBc col; bool tint; int first, count; }; // tint: use caller's color (ghost body)
+struct SpriteMesh { std::vector<MeshPart> parts; };
+
+struct SpriteSet {
+  std::vector<float> xy;          // x,y pairs for every mesh, GL_TRIANGLES order
+  SpriteMesh pac, ghost, melon, heart;
+  float pxPerUnit = 0.0f;         // scale the set was tessellated for
+};
+
+// Segment counts follow the on-screen radius: chords stay within ~1/4 px
+void buildSpriteSet(SpriteSet& s, float pxPerUnit);
+
+
+// =====================================
+// File: include/font5x7.hpp
+// =====================================
+#pragma once
+#include <cstdint>
+
+// Tiny 5x7 bitmap font (digits, A-Z, a few symbols; lowercase maps to upper).
+// Row 0 is the top row; bit 4 is the leftmost column. Unknown chars are blank.
+inline constexpr int FONT_W = 5, FONT_H = 7, FONT_ADVANCE = 6;
+const uint8_t* glyph5x7(char ch);
+
+
+// =====================================
+// File: include/glyphatlas.hpp
+// =====================================
+#pragma once
+#include <string>
+#include <vector>
+
+// Text from one alpha texture holding the 5x7 font (font5x7.hpp). A label
+// keeps its laid-out quads and is only rebuilt when its text changes;
+// drawing it is a single glDrawArrays whatever its length.
+struct TextLabel {
+  std::string text;            // what verts were laid out for
+  std::vector<float> verts;    // x,y,u,v per vertex, in font pixels from the left end of the baseline
+  int width = 0;               // advance width in font pixels (no trailing gap)
+};
+
+// Upload the atlas; call once after the GL context exists
+bool glyphAtlasInit();
+
+// Lay out s unless the label already holds it; true if it was rebuilt
+bool textSet(TextLabel& t, const char* s);
+// Draw with the baseline's left end at (x,yBase); pxSize = world units per font pixel
+void textDraw(const TextLabel& t, float x, float yBase, float pxSize, float r,float g,float b, float a=1.0f);
+
+
+// =====================================
+// File: include/softraster.hpp
+// =====================================
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "sprites.hpp"
+#include "../your-part/include/world.hpp"
+
+// CPU rasterizer backend: draws the in-game scene (maze, actors, supers,
+// heart, HUD, game-over overlay) into an in-memory RGBA8 framebuffer using
+// the same world-to-screen layout as render.cpp. Needs no GL, GLUT or display.
+struct SoftCanvas {
+  int w = 0, h = 0;
+  std::vector<uint32_t> px;   // row-major, top row first; bytes R,G,B,A on little-endian hosts
+  SpriteSet sprites;          // tessellated for this canvas' pixel scale
+  float sx = 1.0f, sy = 1.0f; // pixels per world unit
+};
+
+void softResize(SoftCanvas& cv, int w, int h);
+void softRenderGame(SoftCanvas& cv, const pac::World& world);
+// The passes softRenderGame runs, in order; same split as render.cpp
+void softRenderMaze(SoftCanvas& cv, const pac::World& world);   // also clears
+void softRenderActors(SoftCanvas& cv, const pac::World& world);
+void softRenderSupers(SoftCanvas& cv, const pac::World& world);
+void softRenderHeart(SoftCanvas& cv, const pac::World& world);
+void softRenderHUD(SoftCanvas& cv, const pac::World& world);
+void softRenderGameOverOverlay(SoftCanvas& cv);
+// Binary PPM (RGB) for thumbnails and visual regression diffs
+bool softWritePPM(const SoftCanvas& cv, const char* path);
+
+
+// =====================================
+// File: include/simthread.hpp
+// =====================================
+#pragma once
+#include <chrono>
+#include "../your-part/include/logic.hpp"
+#include "../your-part/include/world.hpp"
+
+// Simulation thread: owns the live World and steps it at a steady SIM_DT,
+// independent of rendering. Each tick it publishes a copy through a lock-free
+// triple buffer; the GLUT thread only ever reads those snapshots and sends
+// inputs back through a lock-free queue.
+
+struct SimFrame {
+  pac::World world;
+  pac::Actor prevPacman, prevGhosts[4];            // positions one tick earlier, for interpolation
+  std::chrono::steady_clock::time_point at;       // when this tick was due
+  unsigned long long tick = 0;   // fixed steps taken this session
+  unsigned games = 0;            // IN_NEW_GAMEs applied so far
+  unsigned long long inputs = 0; // inputs applied so far
+};
+
+// recPath: append this session to an input log for pac_replay (nullptr = off);
+// level: registry index (level.hpp) every game of the session plays
+void simStart(unsigned long long seed, const char* recPath, int level=0);
+// Stops and joins the thread, then closes the input log. Safe to call twice.
+void simStop();
+
+// GLUT thread only
+void simPost(pac::InputCode in);           // applied before the next tick
+const SimFrame& simLatest();               // newest snapshot; valid until the next simLatest()
+unsigned simGamesPosted();                 // IN_NEW_GAMEs sent so far
+unsigned long long simInputsPosted();      // inputs sent so far (dropped ones excluded)
+// MCTS autopilot (mcts.hpp): steers Pac-Man from the simulation thread. Its
+// turns go through applyInput() and the input log like key presses.
+void simSetAutopilot(bool on);
+bool simAutopilot();
+
+// Actor positions for drawing `now`: blended from the previous tick towards
+// f's tick by the time elapsed since f was due, so motion stays smooth at any
+// refresh rate (one tick, 8 ms, behind the simulation). Jumps of a cell or
+// more (respawn, rewind, new game) snap instead of sliding.
+void simInterpolate(const SimFrame& f, std::chrono::steady_clock::time_point now, pac::Actor& pacman, pac::Actor ghosts[4]);
+
+
+// =====================================
+// File: include/redraw.hpp
+// =====================================
+#pragma once
+
+// Redraw scheduler: frames are drawn only while something on screen can
+// change on its own (gameplay, inputs the simulation has not applied yet, the
+// game-over hold, the profiler overlay). Menus, pause and the win screen draw
+// once and then leave the GLUT thread asleep until an event calls
+// requestRedraw(). While animating, redraws follow vsync when the driver
+// honours it, else an absolute --fps schedule.
+
+// After the window exists; falls back to the timer if vsync is off or refused
+void redrawStart(bool wantVsync, double fps);
+// Coalesced: any number of calls before the next frame post one redisplay
+void requestRedraw();
+// End of the display callback: keeps pacing running or lets it go idle
+void redrawFrameDone();
+
+
+// =====================================
+// File: include/bigview.hpp
+// =====================================
+#pragma once
+
+// Soak view for runtime-sized mazes (pacman --big RxC): a BigSim on a
+// scrolling camera. Only the chunks inside the viewport are meshed and drawn;
+// each keeps its wall and pellet buffers in a small GPU cache. Takes over the
+// GLUT callbacks of the current window and never returns.
+void runBigMaze(int rows, int cols, unsigned long long seed, bool wantVsync);
+
+
 // =====================================
 // File: src/render.cpp
 // =====================================
 #include <GL/glut.h>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
 #include "state.hpp"
+#include "render.hpp"
+#include "glbuf.hpp"
+#include "sprites.hpp"
+#include "font5x7.hpp"
+#include "glyphatlas.hpp"
+#include "simthread.hpp"
 
 // Pull in core pieces from your part
 #include "../your-part/include/config.hpp"
 #include "../your-part/include/types.hpp"
+#include "../your-part/include/world.hpp"
 #include "../your-part/include/maze.hpp"
 #include "../your-part/include/logic.hpp"
 #include "../your-part/include/powerups.hpp"
 #include "../your-part/include/util.hpp"
+#include "../your-part/include/profile.hpp"
 
 // Use the pac namespace for core
 using namespace pac;
 
+// Snapshot drawn this frame; renderGame() takes the newest from the simulation thread
+static const World* view = nullptr;
+// Actor positions interpolated for this frame's display time
+static Actor drawPacman, drawGhosts[4];
+
 // ====== local draw utils ======
 static void drawTextColor(const char* s,float x,float y,float r,float g,float b,void* font){
   glColor3f(r,g,b); glRasterPos2f(x,y);
   while(*s) glutBitmapCharacter(font,*s++);
 }
-static void drawQuad(float x0,float y0,float x1,float y1, RGBc c){
-  glColor3f(c.r,c.g,c.b); glBegin(GL_QUADS);
-  glVertex2f(x0,y0); glVertex2f(x1,y0); glVertex2f(x1,y1); glVertex2f(x0,y1); glEnd();
-}
 static void drawQuadA(float x0,float y0,float x1,float y1, float r,float g,float b,float a){
   glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   glColor4f(r,g,b,a); glBegin(GL_QUADS);
   glVertex2f(x0,y0); glVertex2f(x1,y0); glVertex2f(x1,y1); glVertex2f(x0,y1);
   glEnd(); glDisable(GL_BLEND);
 }
-static void drawCircle(float cx,float cy,float r, RGBc c){
-  glColor3f(c.r,c.g,c.b); glBegin(GL_TRIANGLE_FAN);
-  glVertex2f(cx,cy);
-  for(int i=0;i<=40;i++){ float a=i*0.157f; glVertex2f(cx+r*std::cos(a), cy+r*std::sin(a)); }
-  glEnd();
-}
-
-// ===== Watermelon (🍉)
-static void drawWatermelon(float cx,float cy){
-  const float PI = 3.14159265f; const float R=0.35f; float Rw=R, Rw_in=R-0.05f, Rw_white_in=Rw_in-0.03f, Rf=Rw_white_in;
-  glColor3f(1.0f, 0.15f, 0.20f); glBegin(GL_TRIANGLE_FAN); glVertex2f(cx, cy);
-  for(int i=0;i<=64;i++){ float a=(PI*i)/64.0f; glVertex2f(cx + Rf*std::cos(a), cy - Rf*std::sin(a)); } glEnd();
-  glColor3f(0.98f, 0.98f, 0.98f); glBegin(GL_TRIANGLE_STRIP);
-  for(int i=0;i<=64;i++){ float a=(PI*i)/64.0f; glVertex2f(cx + Rw_in*std::cos(a), cy - Rw_in*std::sin(a)); glVertex2f(cx + Rw_white_in*std::cos(a), cy - Rw_white_in*std::sin(a)); } glEnd();
-  glColor3f(0.10f, 0.70f, 0.20f); glBegin(GL_TRIANGLE_STRIP);
-  for(int i=0;i<=64;i++){ float a=(PI*i)/64.0f; glVertex2f(cx + Rw*std::cos(a), cy - Rw*std::sin(a)); glVertex2f(cx + Rw_in*std::cos(a),  cy - Rw_in*std::sin(a)); } glEnd();
-  RGBc seedCol{0.05f,0.05f,0.05f}; float sr=0.03f;
-  drawCircle(cx - 0.16f, cy - 0.18f, sr, seedCol);
-  drawCircle(cx + 0.00f, cy - 0.22f, sr, seedCol);
-  drawCircle(cx + 0.16f, cy - 0.18f, sr, seedCol);
-  drawCircle(cx - 0.08f, cy - 0.28f, sr, seedCol);
-  drawCircle(cx + 0.08f, cy - 0.28f, sr, seedCol);
+// ===== Maze (retained): wall quads live in a static buffer uploaded once per level,
+// dots are one point batch re-uploaded only when the pellet plane changes
+static VertexBuffer wallBuf, dotBuf;
+static BitBoard dotsUploaded; static bool dotsValid=false;
+static int wallsLevel=-1;       // level the wall buffer was built for
+static float pxPerUnit = 40.0f; // set by reshapeView, sizes the dot points
+
+static void syncWallBuffer(){
+  if(wallsLevel==view->level) return;
+  const BitBoard& blocked = levelOf(*view).planes().pacBlocked;
+  static float xy[BOARD_CELLS*12]; int n=0;
+  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++){
+    if(!blocked.test(r,c)) continue;
+    float x0=c+0.06f, y0=(ROWS-1-r)+0.06f, x1=c+0.94f, y1=(ROWS-1-r)+0.94f;
+    float q[12]={x0,y0, x1,y0, x1,y1,  x0,y0, x1,y1, x0,y1};
+    for(float f:q) xy[n++]=f;
+  }
+  glbufUpload(wallBuf, xy, n/2);
+  wallsLevel=view->level;
 }
 
-// ===== Heart (💖)
-static void drawHeart(float cx, float cy){
-  const float r = 0.18f; const float dx = 0.16f; const float dy = 0.05f; const RGBc heartCol{1.00f, 0.20f, 0.70f};
-  drawCircle(cx - dx, cy + dy, r, heartCol);
-  drawCircle(cx + dx, cy + dy, r, heartCol);
-  glColor3f(heartCol.r, heartCol.g, heartCol.b);
-  glBegin(GL_TRIANGLES);
-    glVertex2f(cx - (dx + r*0.70f), cy + dy*0.2f);
-    glVertex2f(cx + (dx + r*0.70f), cy + dy*0.2f);
-    glVertex2f(cx,                  cy - 0.28f);
-  glEnd();
-  glColor3f(1.0f, 0.85f, 0.95f);
-  glBegin(GL_TRIANGLES);
-    glVertex2f(cx + 0.05f, cy + 0.20f);
-    glVertex2f(cx + 0.12f, cy + 0.18f);
-    glVertex2f(cx + 0.08f, cy + 0.25f);
-  glEnd();
-}
-
-// ===== Pac-Man RIGHT local sprite
-static void drawPacRightSpriteLocal(float r){
-  const float TWO_PI = 6.283185307f; const float mouthDeg = 58.0f; const float mouth = mouthDeg * 3.14159265f/180;
-  glColor3f(PAC_COL.r, PAC_COL.g, PAC_COL.b);
-  glBegin(GL_TRIANGLE_FAN);
-    glVertex2f(0.0f, 0.0f);
-    for(int i=0;i<=100;i++){ float a = mouth*0.5f + (TWO_PI - mouth) * (i/100.0f); glVertex2f(r*std::cos(a), r*std::sin(a)); }
-  glEnd();
-  glColor3f(0.0f,0.0f,0.0f);
-  glBegin(GL_TRIANGLES);
-    float a0 = -mouth*0.5f, a1 = +mouth*0.5f;
-    glVertex2f(0.0f,0.0f); glVertex2f(r*std::cos(a0), r*std::sin(a0)); glVertex2f(r*std::cos(a1), r*std::sin(a1));
-  glEnd();
-  RGBc eyeW{1,1,1}, eyeB{0.10f,0.65f,1.0f}; float ew=r*0.23f, ep=r*0.12f;
-  drawCircle(r*0.20f, r*0.25f, ew, eyeW); drawCircle(r*0.27f, r*0.25f, ep, eyeB);
-  RGBc lip{0.85f,0.10f,0.10f}; drawCircle(r*0.88f, -r*0.08f, r*0.06f, lip);
-  RGBc bow{0.90f,0.10f,0.10f}; glColor3f(bow.r,bow.g,bow.b); glBegin(GL_TRIANGLES);
-    glVertex2f(-r*0.15f, +r*0.60f); glVertex2f(-r*0.55f, +r*0.45f); glVertex2f(-r*0.35f, +r*0.80f);
-  glEnd();
-  glBegin(GL_TRIANGLES);
-    glVertex2f(-r*0.05f, +r*0.62f); glVertex2f(+r*0.25f, +r*0.78f); glVertex2f(+r*0.05f, +r*0.40f);
-  glEnd();
-  drawCircle(+r*0.02f, +r*0.58f, r*0.10f, bow);
-}
-
-// ===== Ghost sprite
-static void drawGhostSprite(float cx, float cy, float r, RGBc bodyCol){
-  const float PI = 3.14159265f; float w=r*2.0f, h=r*2.2f, halfW=w*0.5f;
-  glColor3f(bodyCol.r, bodyCol.g, bodyCol.b);
-  glBegin(GL_TRIANGLE_FAN); glVertex2f(cx, cy + h*0.15f);
-  for(int i=0;i<=64;i++){ float a = PI*(i/64.0f); glVertex2f(cx + halfW*std::cos(a), cy + h*0.15f + halfW*std::sin(a)); }
-  glEnd();
-  glBegin(GL_QUADS);
-    glVertex2f(cx - halfW, cy - h*0.55f); glVertex2f(cx + halfW, cy - h*0.55f);
-    glVertex2f(cx + halfW, cy + h*0.15f); glVertex2f(cx - halfW, cy + h*0.15f);
-  glEnd();
-  float bumpR = w/6.0f; float startX = cx - halfW + bumpR;
-  for(int k=0;k<3;k++){ float bx = startX + k*(2*bumpR);
-    glBegin(GL_TRIANGLE_FAN); glVertex2f(bx, cy - h*0.55f);
-    for(int i=0;i<=32;i++){ float a = 3.14159265f + 3.14159265f*(i/32.0f); glVertex2f(bx + bumpR*std::cos(a), cy - h*0.55f + bumpR*std::sin(a)); }
-    glEnd();
-  }
-  RGBc eyeW{1,1,1}, eyeB{0.10f,0.65f,1.0f}; float eyeR=r*0.28f, pupilR=r*0.16f;
-  float lcx=cx - r*0.35f, rcx=cx + r*0.15f, ey=cy + r*0.25f;
-  drawCircle(lcx, ey, eyeR, eyeW); drawCircle(rcx, ey, eyeR, eyeW);
-  drawCircle(lcx - r*0.10f, ey, pupilR, eyeB); drawCircle(rcx - r*0.10f, ey, pupilR, eyeB);
+static void syncDotBuffer(){
+  if(dotsValid && view->pellets==dotsUploaded) return;
+  static float xy[BOARD_CELLS*2]; int n=0;
+  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++){
+    if(!view->pellets.test(r,c)) continue;
+    xy[n*2]=c+0.5f; xy[n*2+1]=(ROWS-1-r)+0.5f; n++;
+  }
+  if(!dotBuf.capacity) glbufUpload(dotBuf, xy, BOARD_CELLS, true);
+  glbufUpdate(dotBuf, 0, xy, n); dotBuf.count=n;
+  dotsUploaded=view->pellets; dotsValid=true;
+}
+
+// ===== Sprites (cached): tessellated once per window scale into one buffer,
+// each frame only pushes a transform and issues one draw per color run
+static SpriteSet sprites; static VertexBuffer spriteBuf;
+
+static void ensureSprites(){
+  if(spriteBuf.count && sprites.pxPerUnit==pxPerUnit) return;
+  buildSpriteSet(sprites, pxPerUnit);
+  glbufUpload(spriteBuf, sprites.xy.data(), (int)sprites.xy.size()/2);
+}
+
+static void drawSprite(const SpriteMesh& m, float x, float y, float angleDeg=0.0f, const RGBc* tint=nullptr){
+  glPushMatrix(); glTranslatef(x, y, 0.0f);
+  if(angleDeg!=0.0f) glRotatef(angleDeg, 0.0f, 0.0f, 1.0f);
+  for(const MeshPart& p : m.parts){
+    const RGBc& c = (p.tint && tint) ? *tint : p.col;
+    glColor3f(c.r,c.g,c.b); glDrawArrays(GL_TRIANGLES, p.first, p.count);
+  }
+  glPopMatrix();
+}
+
+// ===== Text (atlas): HUD and banners are cached labels, one draw each
+static TextLabel hudLine, pausedLabel, winLabel, gameOverLabel, aiLabel;
+static int hudScore=-1, hudLives=-1; static long hudTenths=-1;
+
+void initRenderer(){
+  glbufInit();
+  glyphAtlasInit();
+  textSet(pausedLabel, "PAUSED"); textSet(winLabel, "YOU WIN!"); textSet(gameOverLabel, "GAME OVER"); textSet(aiLabel, "AI");
+  wallsLevel=-1; dotsValid=false;
+  ensureSprites();
 }
 
 void renderMaze(){
+  PAC_PROFILE_SCOPE("renderMaze");
   glClearColor(BG_COL.r,BG_COL.g,BG_COL.b,1.0f); glClear(GL_COLOR_BUFFER_BIT);
-  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++){
-    float x=c,y=(ROWS-1-r);
-    if(MAZE[r][c]==WALL||MAZE[r][c]==GATE) drawQuad(x+0.06f,y+0.06f,x+0.94f,y+0.94f,WALL_COL);
-    else if(MAZE[r][c]==DOTCELL) drawCircle(x+0.5f,y+0.5f,0.08f,DOT_COL);
-  }
+  syncWallBuffer();
+  glColor3f(WALL_COL.r,WALL_COL.g,WALL_COL.b);
+  glbufDraw(wallBuf, GL_TRIANGLES, 0, wallBuf.count);
+  syncDotBuffer();
+  glEnable(GL_POINT_SMOOTH); glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glPointSize(0.16f*pxPerUnit);
+  glColor3f(DOT_COL.r,DOT_COL.g,DOT_COL.b);
+  glbufDraw(dotBuf, GL_POINTS, 0, dotBuf.count);
+  glDisable(GL_BLEND); glDisable(GL_POINT_SMOOTH);
 }
 
 void renderActors(){
-  glPushMatrix();
-  glTranslatef(pacman.x, pacman.y, 0.0f);
+  PAC_PROFILE_SCOPE("renderActors");
+  const Actor& pacman = drawPacman; const Actor* ghosts = drawGhosts;
   float extraFlip = (/* death flip visuals handled by angle in core */ 0.0f);
-  extern Runtime RT; // defined in main.cpp
-  glRotatef(RT.pacAngleDeg + extraFlip, 0.0f, 0.0f, 1.0f);
-  drawPacRightSpriteLocal(pacman.radius * 1.15f);
-  glPopMatrix();
+  glbufBind(spriteBuf);
+  drawSprite(sprites.pac, pacman.x, pacman.y, view->rt.pacAngleDeg + extraFlip);
   RGBc gc[4]={BLINKY_COL,PINKY_COL,INKY_COL,CLYDE_COL};
-  for(int i=0;i<4;i++) drawGhostSprite(ghosts[i].x, ghosts[i].y, ghosts[i].radius * 1.05f, gc[i]);
+  for(int i=0;i<4;i++) drawSprite(sprites.ghost, ghosts[i].x, ghosts[i].y, 0.0f, &gc[i]);
+  glbufUnbind();
 }
 
-void renderSupers(){ for(int i=0;i<MAX_SUPERS;i++){ if(!supers[i].active) continue; drawWatermelon(cellCenterX(supers[i].c), cellCenterY(supers[i].r)); }}
-void renderHeart(){ if(!heart.active) return; drawHeart(cellCenterX(heart.c), cellCenterY(heart.r)); }
+void renderSupers(){
+  const SuperFood* supers=view->supers; glbufBind(spriteBuf);
+  for(int i=0;i<MAX_SUPERS;i++){ if(!supers[i].active) continue; drawSprite(sprites.melon, cellCenterX(supers[i].c), cellCenterY(supers[i].r)); }
+  glbufUnbind();
+}
+void renderHeart(){ const Heart& heart=view->heart; if(!heart.active) return; glbufBind(spriteBuf); drawSprite(sprites.heart, cellCenterX(heart.c), cellCenterY(heart.r)); glbufUnbind(); }
 
 void renderHUD(){
-  char buf[128];
-  using Clock = std::chrono::steady_clock; extern Runtime RT;
-  float secs=std::chrono::duration<float>(Clock::now()-RT.tStart).count();
-  std::snprintf(buf,sizeof(buf),"SCORE:%d  LIVES:%d  TIME:%.1fs", RT.score, RT.lives, secs);
-  drawTextColor(buf,0.6f,ROWS+0.3f,HUD_COL.r,HUD_COL.g,HUD_COL.b,GLUT_BITMAP_9_BY_15);
-  if(RT.paused && !RT.winGame && !RT.gameOver) drawTextColor("PAUSED",8,10,1,1,1,GLUT_BITMAP_HELVETICA_18);
-  if(RT.winGame)  drawTextColor("YOU WIN!",8,10,1,1,0,GLUT_BITMAP_HELVETICA_18);
+  PAC_PROFILE_SCOPE("renderHUD");
+  const Runtime& RT = view->rt;
+  // Reformatted only when a shown value changes: score, lives or the tenths digit
+  long tenths=std::lround(RT.simTime*10.0f);
+  if(RT.score!=hudScore || RT.lives!=hudLives || tenths!=hudTenths){
+    char buf[128];
+    std::snprintf(buf,sizeof(buf),"SCORE:%d  LIVES:%d  TIME:%ld.%lds", RT.score, RT.lives, tenths/10, tenths%10);
+    textSet(hudLine, buf); hudScore=RT.score; hudLives=RT.lives; hudTenths=tenths;
+  }
+  textDraw(hudLine, 0.6f, ROWS+0.3f, 0.40f/FONT_H, HUD_COL.r,HUD_COL.g,HUD_COL.b);
+  if(RT.paused && !RT.winGame && !RT.gameOver) textDraw(pausedLabel, 8, 10, 0.5f/FONT_H, 1,1,1);
+  if(RT.winGame) textDraw(winLabel, 8, 10, 0.5f/FONT_H, 1,1,0);
+  if(simAutopilot()) textDraw(aiLabel, COLS-1.4f, ROWS+0.3f, 0.40f/FONT_H, 1,0.4f,0.4f);
 }
 
-// ===== BIG GAME OVER overlay
-static float strokeTextWidth(const char* s, void* font=GLUT_STROKE_MONO_ROMAN){ float w=0.0f; for(const char* p=s; *p; ++p) w += glutStrokeWidth(font, *p); return w; }
+// ===== BIG GAME OVER overlay: dark band, text fitted to 88% of its width
+// with a one-pixel drop shadow
 void renderGameOverOverlay(){
-  const char* msg = "GAME OVER"; float padX=2.0f, padY=1.2f; float x0=padX, x1=COLS-padX; float yMid = ROWS * 0.55f; float y0 = yMid - padY, y1 = yMid + padY;
+  float padX=2.0f, padY=1.2f; float x0=padX, x1=COLS-padX; float yMid = ROWS * 0.55f; float y0 = yMid - padY, y1 = yMid + padY;
   drawQuadA(x0, y0, x1, y1, 0.0f, 0.0f, 0.0f, 0.55f);
-  void* font = GLUT_STROKE_MONO_ROMAN; float wUnits = strokeTextWidth(msg, font); float targetW = (x1 - x0) * 0.88f; float scale = (wUnits>0.0f)?(targetW/wUnits):0.01f; const float STROKE_H = 119.05f;
-  float textW_world = wUnits * scale; float textH_world = STROKE_H * scale; float tx = (COLS - textW_world) * 0.5f; float ty = yMid - textH_world * 0.5f;
-  glPushMatrix(); glTranslatef(tx + 0.05f, ty - 0.05f, 0.0f); glScalef(scale, scale, 1.0f); glLineWidth(6.0f); glColor3f(0,0,0); for(const char* p = msg; *p; ++p) glutStrokeCharacter(font, *p); glPopMatrix();
-  glPushMatrix(); glTranslatef(tx, ty, 0.0f); glScalef(scale, scale, 1.0f); glLineWidth(5.0f); glColor3f(1,1,1); for(const char* p = msg; *p; ++p) glutStrokeCharacter(font, *p); glPopMatrix();
+  float px = (x1 - x0) * 0.88f / gameOverLabel.width; float tx = (COLS - gameOverLabel.width*px) * 0.5f; float ty = yMid - FONT_H*px*0.5f;
+  textDraw(gameOverLabel, tx + px, ty - px, px, 0,0,0);
+  textDraw(gameOverLabel, tx, ty, px, 1,1,1);
+}
+
+// ===== Profiler overlay (F3): p50/p99 per zone and a frame-time histogram
+void renderProfilerOverlay(){
+  ProfRow rows[PROF_MAX_ZONES]; int n=profileSummary(rows, PROF_MAX_ZONES);
+  const float lineH=0.5f, x0=0.3f, x1=11.8f, yTop=ROWS-0.2f;
+  const int NBINS=34; const float MAX_MS=34.0f, histH=2.4f;
+  float y1=yTop-lineH*(n+1)-histH-0.5f;
+  drawQuadA(x0, y1, x1, yTop, 0,0,0,0.7f);
+  char buf[96]; float y=yTop-lineH;
+  drawTextColor("zone            last   p50   p99 ms", x0+0.2f, y, 0.6f,0.9f,1.0f, GLUT_BITMAP_8_BY_13);
+  for(int i=0;i<n;i++){
+    y-=lineH;
+    std::snprintf(buf,sizeof(buf),"%-14s %6.2f %5.2f %5.2f", rows[i].name, rows[i].lastMs, rows[i].p50Ms, rows[i].p99Ms);
+    drawTextColor(buf, x0+0.2f, y, 1,1,1, GLUT_BITMAP_8_BY_13);
+  }
+  // Frame-time histogram, 1 ms per bin; the bin holding 16.7 ms is the 60 fps budget
+  int bins[NBINS]; profileFrameHistogram(bins, NBINS, MAX_MS);
+  int peak=1; for(int b:bins) peak=std::max(peak,b);
+  float hx0=x0+0.2f, hx1=x1-0.2f, hy0=y1+0.3f, bw=(hx1-hx0)/NBINS;
+  for(int b=0;b<NBINS;b++){
+    if(!bins[b]) continue;
+    bool over = (b+1)*MAX_MS/NBINS > 1000.0f/60.0f;
+    drawQuadA(hx0+b*bw, hy0, hx0+(b+1)*bw-0.03f, hy0+histH*bins[b]/peak, over?1.0f:0.3f, over?0.35f:0.9f, 0.3f, 0.9f);
+  }
+  drawQuadA(hx0+bw*(1000.0f/60.0f)/(MAX_MS/NBINS), hy0, hx0+bw*(1000.0f/60.0f)/(MAX_MS/NBINS)+0.04f, hy0+histH, 1,1,0,0.8f);
+  if(profileCapturing()) drawTextColor("REC", x1-1.2f, yTop-lineH, 1,0.3f,0.3f, GLUT_BITMAP_8_BY_13);
 }
 
 // ===== Menus
@@ -262,12 +517,16 @@ void renderQuitConfirmMenu(){
 }
 
 void renderGame(){
+  const SimFrame& f = simLatest(); view = &f.world;
+  simInterpolate(f, std::chrono::steady_clock::now(), drawPacman, drawGhosts);
   renderMaze();
   renderActors();
   renderSupers();
   renderHeart();
   renderHUD();
-  extern Runtime RT; if(RT.gameOver && gState==GameState::PLAYING) renderGameOverOverlay();
+  if(view->rt.gameOver && gState==GameState::PLAYING) renderGameOverOverlay();
+  if(showProfiler) renderProfilerOverlay();
+  PAC_PROFILE_SCOPE("swapBuffers");
   glutSwapBuffers();
 }
 
@@ -279,6 +538,8 @@ void renderDisplay(){
 }
 
 void reshapeView(int w,int h){
+  pxPerUnit = std::fmin(w/(float)COLS, h/(ROWS+1.2f));
+  ensureSprites();
   glViewport(0,0,w,h); glMatrixMode(GL_PROJECTION); glLoadIdentity(); gluOrtho2D(0,COLS,0,ROWS+1.2); glMatrixMode(GL_MODELVIEW); glLoadIdentity();
 }
 
@@ -287,46 +548,1281 @@ void reshapeView(int w,int h){
 // File: src/input.cpp
 // =====================================
 #include <GL/glut.h>
+#include <cstdio>
 #include "state.hpp"
 #include "render.hpp"
+#include "input.hpp"
+#include "simthread.hpp"
+#include "redraw.hpp"
 
 // Core
 #include "../your-part/include/types.hpp"
 #include "../your-part/include/config.hpp"
+#include "../your-part/include/world.hpp"
 #include "../your-part/include/logic.hpp"
+#include "../your-part/include/profile.hpp"
 
 using namespace pac;
 
-// Global from main.cpp
-extern Runtime RT;
+// Game state lives on the simulation thread; guards read its latest snapshot
+// and inputs are queued to it. The core re-checks every guard when applying.
+// Every input wakes the redraw scheduler, which keeps drawing until the
+// simulation has applied it.
+static const Runtime& rt(){ return simLatest().world.rt; }
+static void play(InputCode in){ simPost(in); requestRedraw(); }
 
 static inline float windowToWorldY(int y){ int winH=glutGet(GLUT_WINDOW_HEIGHT); return (float)(winH - y) / winH * (ROWS+1.2f); }
 
+// F3 toggles the frame-time overlay; F4 starts a trace capture and, pressed
+// again, writes it to pac_trace.json. Profiling runs only while either is on.
+static void onProfilerKey(int key){
+  if(key==GLUT_KEY_F3) showProfiler=!showProfiler;
+  if(key==GLUT_KEY_F4){
+    if(!profileCapturing()) profileCapture(true);
+    else if(profileWriteTrace("pac_trace.json")) std::printf("trace written to pac_trace.json\n");
+    else std::fprintf(stderr,"cannot write pac_trace.json\n");
+  }
+  profileEnable(showProfiler || profileCapturing());
+  requestRedraw();
+}
+
 void onSpecialKey(int key,int,int){
-  if(gState!=GameState::PLAYING || RT.gameOver || RT.winGame || RT.deathActive) return;
-  if(key==GLUT_KEY_UP){   pacman.vx=0;  pacman.vy=+1; RT.pacAngleDeg =  90.0f; }
-  if(key==GLUT_KEY_DOWN){ pacman.vx=0;  pacman.vy=-1; RT.pacAngleDeg = -90.0f; }
-  if(key==GLUT_KEY_LEFT){ pacman.vx=-1; pacman.vy=0;  RT.pacAngleDeg = 180.0f; }
-  if(key==GLUT_KEY_RIGHT){pacman.vx=+1; pacman.vy=0;  RT.pacAngleDeg =   0.0f; }
+  if(key==GLUT_KEY_F3 || key==GLUT_KEY_F4){ onProfilerKey(key); return; }
+  if(gState!=GameState::PLAYING) return;
+  const Runtime& RT = rt(); if(RT.gameOver || RT.winGame || RT.deathActive) return;
+  if(key==GLUT_KEY_UP)    play(IN_UP);
+  if(key==GLUT_KEY_DOWN)  play(IN_DOWN);
+  if(key==GLUT_KEY_LEFT)  play(IN_LEFT);
+  if(key==GLUT_KEY_RIGHT) play(IN_RIGHT);
 }
 
 void onKeyDown(unsigned char k,int,int){
   if(k==27) exit(0);
-  if(k=='p'||k=='P'){ if(gState==GameState::PLAYING && !RT.deathActive && !RT.gameOver && !RT.winGame){ RT.paused=!RT.paused; glutPostRedisplay(); } }
-  if(k=='r'||k=='R'){ if(gState==GameState::PLAYING) startNewGame(RT); }
+  if(k=='p'||k=='P'){ if(gState==GameState::PLAYING && !rt().deathActive && !rt().gameOver && !rt().winGame){ play(IN_PAUSE); } }
+  if(k=='r'||k=='R'){ if(gState==GameState::PLAYING) play(IN_NEW_GAME); }
+  if(k=='z'||k=='Z'){ if(gState==GameState::PLAYING){ play(IN_REWIND); } }
+  if(k=='a'||k=='A'){ simSetAutopilot(!simAutopilot()); requestRedraw(); }
 }
 
 void onMouseClick(int button,int state,int x,int y){
   if(button!=GLUT_LEFT_BUTTON || state!=GLUT_DOWN) return; float wy = windowToWorldY(y);
-  if(gState==GameState::MENU){ if(wy>8.5f && wy<9.5f){ gState=GameState::PLAYING; startNewGame(RT); return; } if(wy>6.5f && wy<7.5f){ exit(0); } return; }
-  if(gState==GameState::POSTGAME_MENU){ if(wy>8.5f && wy<9.5f){ startNewGame(RT); return; } if(wy>6.5f && wy<7.5f){ gState=GameState::QUIT_CONFIRM_MENU; glutPostRedisplay(); return; } return; }
-  if(gState==GameState::QUIT_CONFIRM_MENU){ if(wy>8.5f && wy<9.5f){ RT.paused=false; RT.gameOver=false; RT.winGame=false; RT.deathActive=false; RT.postMenuShown=false; gState=GameState::MENU; RT.tStart = RT.tLast = std::chrono::steady_clock::now(); glutPostRedisplay(); return; } if(wy>6.5f && wy<7.5f){ gState=GameState::POSTGAME_MENU; glutPostRedisplay(); return; } return; }
+  if(gState==GameState::MENU){ if(wy>8.5f && wy<9.5f){ gState=GameState::PLAYING; play(IN_NEW_GAME); return; } if(wy>6.5f && wy<7.5f){ exit(0); } return; }
+  if(gState==GameState::POSTGAME_MENU){ if(wy>8.5f && wy<9.5f){ gState=GameState::PLAYING; play(IN_NEW_GAME); return; } if(wy>6.5f && wy<7.5f){ gState=GameState::QUIT_CONFIRM_MENU; requestRedraw(); return; } return; }
+  if(gState==GameState::QUIT_CONFIRM_MENU){ if(wy>8.5f && wy<9.5f){ gState=GameState::MENU; requestRedraw(); return; } if(wy>6.5f && wy<7.5f){ gState=GameState::POSTGAME_MENU; requestRedraw(); return; } return; }
 }
 
+// Redraw only when a hover flag flips, not on every mouse move
+static void setHover(int& flag, bool on){ if(flag!=(int)on){ flag=on; requestRedraw(); } }
 void onPassiveMotion(int x,int y){ float wy = windowToWorldY(y);
-  if(gState==GameState::MENU){ hoverPlay=(wy>8.5f&&wy<9.5f); hoverExit=(wy>6.5f&&wy<7.5f); glutPostRedisplay(); return; }
-  if(gState==GameState::POSTGAME_MENU){ hoverPG_PlayAgain=(wy>8.5f&&wy<9.5f); hoverPG_Quit=(wy>6.5f&&wy<7.5f); glutPostRedisplay(); return; }
-  if(gState==GameState::QUIT_CONFIRM_MENU){ hoverQC_PlayAgain=(wy>8.5f && wy<9.5f); hoverQC_Quit=(wy>6.5f && wy<7.5f); glutPostRedisplay(); return; }
+  if(gState==GameState::MENU){ setHover(hoverPlay, wy>8.5f&&wy<9.5f); setHover(hoverExit, wy>6.5f&&wy<7.5f); return; }
+  if(gState==GameState::POSTGAME_MENU){ setHover(hoverPG_PlayAgain, wy>8.5f&&wy<9.5f); setHover(hoverPG_Quit, wy>6.5f&&wy<7.5f); return; }
+  if(gState==GameState::QUIT_CONFIRM_MENU){ setHover(hoverQC_PlayAgain, wy>8.5f && wy<9.5f); setHover(hoverQC_Quit, wy>6.5f && wy<7.5f); return; }
+}
+
+
+// =====================================
+// File: src/glbuf.cpp
+// =====================================
+#include <cstddef>
+#include <cstdio>
+#include "glbuf.hpp"
+#ifdef FREEGLUT
+#include <GL/freeglut_ext.h>
+#endif
+#if defined(FREEGLUT) && !defined(_WIN32) && !defined(__APPLE__)
+#include <GL/glx.h>
+#define PAC_GLX 1
+#endif
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER  0x8892
+#define GL_STATIC_DRAW   0x88E4
+#define GL_DYNAMIC_DRAW  0x88E8
+#endif
+
+// GL 1.5 buffer objects are not in the 1.1 headers some platforms ship,
+// so the entry points are looked up at runtime
+typedef void (APIENTRY *GenBuffersFn)(GLsizei, GLuint*);
+typedef void (APIENTRY *BindBufferFn)(GLenum, GLuint);
+typedef void (APIENTRY *BufferDataFn)(GLenum, std::ptrdiff_t, const void*, GLenum);
+typedef void (APIENTRY *BufferSubDataFn)(GLenum, std::ptrdiff_t, std::ptrdiff_t, const void*);
+
+static GenBuffersFn    pGenBuffers    = nullptr;
+static BindBufferFn    pBindBuffer    = nullptr;
+static BufferDataFn    pBufferData    = nullptr;
+static BufferSubDataFn pBufferSubData = nullptr;
+
+bool glbufInit(){
+#ifdef FREEGLUT
+  pGenBuffers    = (GenBuffersFn)   glutGetProcAddress("glGenBuffers");
+  pBindBuffer    = (BindBufferFn)   glutGetProcAddress("glBindBuffer");
+  pBufferData    = (BufferDataFn)   glutGetProcAddress("glBufferData");
+  pBufferSubData = (BufferSubDataFn)glutGetProcAddress("glBufferSubData");
+#endif
+  if(!pGenBuffers || !pBindBuffer || !pBufferData || !pBufferSubData){
+    pGenBuffers=nullptr; pBindBuffer=nullptr; pBufferData=nullptr; pBufferSubData=nullptr;
+  }
+  return glbufHasVBO();
+}
+
+bool glbufHasVBO(){ return pGenBuffers!=nullptr; }
+
+void glbufUpload(VertexBuffer& vb, const float* xy, int nVerts, bool dynamic){
+  vb.count = vb.capacity = nVerts;
+  if(!glbufHasVBO()){ vb.cpu.assign(xy, xy + nVerts*2); return; }
+  if(!vb.id) pGenBuffers(1, &vb.id);
+  pBindBuffer(GL_ARRAY_BUFFER, vb.id);
+  pBufferData(GL_ARRAY_BUFFER, (std::ptrdiff_t)(nVerts*2*sizeof(float)), xy, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+  pBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void glbufUpdate(VertexBuffer& vb, int first, const float* xy, int nVerts){
+  if(first<0 || first+nVerts>vb.capacity) return;
+  if(!vb.id){ for(int i=0;i<nVerts*2;i++) vb.cpu[first*2+i]=xy[i]; return; }
+  pBindBuffer(GL_ARRAY_BUFFER, vb.id);
+  pBufferSubData(GL_ARRAY_BUFFER, (std::ptrdiff_t)(first*2*sizeof(float)), (std::ptrdiff_t)(nVerts*2*sizeof(float)), xy);
+  pBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void glbufBind(const VertexBuffer& vb){
+  glEnableClientState(GL_VERTEX_ARRAY);
+  if(vb.id){ pBindBuffer(GL_ARRAY_BUFFER, vb.id); glVertexPointer(2, GL_FLOAT, 0, (const void*)0); }
+  else     glVertexPointer(2, GL_FLOAT, 0, vb.cpu.data());
+}
+
+void glbufUnbind(){
+  if(glbufHasVBO()) pBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void glbufDraw(const VertexBuffer& vb, GLenum mode, int first, int n){
+  if(n<=0) return;
+  glbufBind(vb);
+  glDrawArrays(mode, first, n);
+  glbufUnbind();
+}
+
+// GLX_MESA/SGI_swap_control return 0 on success, WGL_EXT_swap_control TRUE;
+// GLX_EXT_swap_control sets the current drawable's interval and returns nothing
+typedef int (APIENTRY *SwapIntervalFn)(int);
+#ifdef PAC_GLX
+typedef void (APIENTRY *SwapIntervalExtFn)(Display*, GLXDrawable, int);
+#endif
+
+bool glSetSwapInterval(int interval){
+#ifdef FREEGLUT
+#ifdef PAC_GLX
+  if(SwapIntervalExtFn fn = (SwapIntervalExtFn)glutGetProcAddress("glXSwapIntervalEXT")){
+    Display* dpy = glXGetCurrentDisplay(); GLXDrawable d = glXGetCurrentDrawable();
+    if(dpy && d){ fn(dpy, d, interval); return true; }
+  }
+#endif
+  if(SwapIntervalFn fn = (SwapIntervalFn)glutGetProcAddress("glXSwapIntervalMESA")) return fn(interval)==0;
+  if(SwapIntervalFn fn = (SwapIntervalFn)glutGetProcAddress("glXSwapIntervalSGI"))  return fn(interval)==0;
+  if(SwapIntervalFn fn = (SwapIntervalFn)glutGetProcAddress("wglSwapIntervalEXT"))  return fn(interval)!=0;
+#endif
+  (void)interval;
+  std::fprintf(stderr, "glSetSwapInterval: no swap-control entry point (GLX EXT/MESA/SGI, WGL EXT); swap interval left to the driver\n");
+  return false;
+}
+
+
+// =====================================
+// File: src/sprites.cpp
+// =====================================
+#include <cmath>
+#include "sprites.hpp"
+#include "../your-part/include/config.hpp"
+
+using namespace pac;
+
+// Actor sizes the sprites are drawn at (matches the radius scaling in render.cpp)
+static const float PAC_R   = 0.33f*1.15f;
+static const float GHOST_R = 0.33f*1.05f;
+
+namespace {
+struct Builder {
+  SpriteSet& s; SpriteMesh* mesh; float pxPerUnit;
+
+  int segs(float r, float span) const {
+    float rPx = r*pxPerUnit; if(rPx<0.5f) return 4;
+    float t = 1.0f - 0.25f/rPx; if(t<-1.0f) t=-1.0f;
+    int n = (int)std::ceil(std::fabs(span) / (2.0f*std::acos(t)));
+    return n<4 ? 4 : (n>128 ? 128 : n);
+  }
+  // Start a new draw range unless the color is unchanged
+  void color(RGBc c, bool tint=false){
+    int at=(int)s.xy.size()/2;
+    if(!mesh->parts.empty()){
+      MeshPart& p=mesh->parts.back();
+      if(p.tint==tint && (tint || (p.col.r==c.r && p.col.g==c.g && p.col.b==c.b))) return;
+    }
+    mesh->parts.push_back({c,tint,at,0});
+  }
+  void v(float x,float y){ s.xy.push_back(x); s.xy.push_back(y); mesh->parts.back().count++; }
+  void tri(float x0,float y0,float x1,float y1,float x2,float y2){ v(x0,y0); v(x1,y1); v(x2,y2); }
+  void quad(float x0,float y0,float x1,float y1){ tri(x0,y0,x1,y0,x1,y1); tri(x0,y0,x1,y1,x0,y1); }
+  // Pie slice from angle a0 to a1 (a1<a0 sweeps clockwise)
+  void fan(float cx,float cy,float r,float a0,float a1){
+    int n=segs(r,a1-a0);
+    for(int i=0;i<n;i++){
+      float u0=a0+(a1-a0)*i/n, u1=a0+(a1-a0)*(i+1)/n;
+      tri(cx,cy, cx+r*std::cos(u0),cy+r*std::sin(u0), cx+r*std::cos(u1),cy+r*std::sin(u1));
+    }
+  }
+  void circle(float cx,float cy,float r){ fan(cx,cy,r,0.0f,6.283185307f); }
+  // Band between two radii over [a0,a1]
+  void ring(float cx,float cy,float rOut,float rIn,float a0,float a1){
+    int n=segs(rOut,a1-a0);
+    for(int i=0;i<n;i++){
+      float u0=a0+(a1-a0)*i/n, u1=a0+(a1-a0)*(i+1)/n;
+      float c0=std::cos(u0), s0=std::sin(u0), c1=std::cos(u1), s1=std::sin(u1);
+      tri(cx+rOut*c0,cy+rOut*s0, cx+rOut*c1,cy+rOut*s1, cx+rIn*c1,cy+rIn*s1);
+      tri(cx+rOut*c0,cy+rOut*s0, cx+rIn*c1,cy+rIn*s1,   cx+rIn*c0,cy+rIn*s0);
+    }
+  }
+};
+} // namespace
+
+// ===== Pac-Man facing right
+static void buildPac(Builder& b){
+  const float PI=3.14159265f, r=PAC_R, mouth=58.0f*PI/180;
+  b.color(PAC_COL);   b.fan(0,0,r, mouth*0.5f, 2*PI-mouth*0.5f);
+  b.color({0,0,0});   b.tri(0,0, r*std::cos(-mouth*0.5f),r*std::sin(-mouth*0.5f), r*std::cos(mouth*0.5f),r*std::sin(mouth*0.5f));
+  b.color({1,1,1});   b.circle(r*0.20f, r*0.25f, r*0.23f);
+  b.color({0.10f,0.65f,1.0f}); b.circle(r*0.27f, r*0.25f, r*0.12f);
+  b.color({0.85f,0.10f,0.10f}); b.circle(r*0.88f, -r*0.08f, r*0.06f);
+  b.color({0.90f,0.10f,0.10f});
+  b.tri(-r*0.15f,+r*0.60f, -r*0.55f,+r*0.45f, -r*0.35f,+r*0.80f);
+  b.tri(-r*0.05f,+r*0.62f, +r*0.25f,+r*0.78f, +r*0.05f,+r*0.40f);
+  b.circle(+r*0.02f, +r*0.58f, r*0.10f);
+}
+
+// ===== Ghost (body drawn in the caller's color)
+static void buildGhost(Builder& b){
+  const float PI=3.14159265f, r=GHOST_R; float w=r*2.0f, h=r*2.2f, halfW=w*0.5f;
+  b.color({1,1,1}, true);
+  b.fan(0, h*0.15f, halfW, 0, PI);
+  b.quad(-halfW, -h*0.55f, halfW, h*0.15f);
+  float bumpR=w/6.0f, startX=-halfW+bumpR;
+  for(int k=0;k<3;k++) b.fan(startX+k*(2*bumpR), -h*0.55f, bumpR, PI, 2*PI);
+  float lcx=-r*0.35f, rcx=r*0.15f, ey=r*0.25f;
+  b.color({1,1,1});             b.circle(lcx,ey,r*0.28f); b.circle(rcx,ey,r*0.28f);
+  b.color({0.10f,0.65f,1.0f});  b.circle(lcx-r*0.10f,ey,r*0.16f); b.circle(rcx-r*0.10f,ey,r*0.16f);
+}
+
+// ===== Watermelon (🍉): lower half slice
+static void buildMelon(Builder& b){
+  const float PI=3.14159265f, R=0.35f; float Rw=R, Rw_in=R-0.05f, Rw_white_in=Rw_in-0.03f, Rf=Rw_white_in;
+  b.color({1.0f,0.15f,0.20f});  b.fan(0,0,Rf, 0,-PI);
+  b.color({0.98f,0.98f,0.98f}); b.ring(0,0,Rw_in,Rw_white_in, 0,-PI);
+  b.color({0.10f,0.70f,0.20f}); b.ring(0,0,Rw,Rw_in, 0,-PI);
+  b.color({0.05f,0.05f,0.05f}); float sr=0.03f;
+  b.circle(-0.16f,-0.18f,sr); b.circle(0.00f,-0.22f,sr); b.circle(0.16f,-0.18f,sr);
+  b.circle(-0.08f,-0.28f,sr); b.circle(0.08f,-0.28f,sr);
+}
+
+// ===== Heart (💖)
+static void buildHeart(Builder& b){
+  const float r=0.18f, dx=0.16f, dy=0.05f;
+  b.color({1.00f,0.20f,0.70f});
+  b.circle(-dx,dy,r); b.circle(dx,dy,r);
+  b.tri(-(dx+r*0.70f),dy*0.2f, (dx+r*0.70f),dy*0.2f, 0,-0.28f);
+  b.color({1.0f,0.85f,0.95f});
+  b.tri(0.05f,0.20f, 0.12f,0.18f, 0.08f,0.25f);
+}
+
+void buildSpriteSet(SpriteSet& s, float pxPerUnit){
+  s.xy.clear(); s.pxPerUnit = pxPerUnit;
+  Builder b{s, nullptr, pxPerUnit};
+  SpriteMesh* meshes[4]={&s.pac,&s.ghost,&s.melon,&s.heart};
+  void (*build[4])(Builder&)={buildPac,buildGhost,buildMelon,buildHeart};
+  for(int i=0;i<4;i++){ meshes[i]->parts.clear(); b.mesh=meshes[i]; build[i](b); }
+}
+
+
+// =====================================
+// File: src/font5x7.cpp
+// =====================================
+#include "font5x7.hpp"
+
+static const uint8_t BLANK[7] = {0,0,0,0,0,0,0};
+static const uint8_t DIGITS[10][7] = {
+  {0x0E,0x11,0x13,0x15,0x19,0x11,0x0E}, {0x04,0x0C,0x04,0x04,0x04,0x04,0x0E},
+  {0x0E,0x11,0x01,0x02,0x04,0x08,0x1F}, {0x1F,0x02,0x04,0x02,0x01,0x11,0x0E},
+  {0x02,0x06,0x0A,0x12,0x1F,0x02,0x02}, {0x1F,0x10,0x1E,0x01,0x01,0x11,0x0E},
+  {0x06,0x08,0x10,0x1E,0x11,0x11,0x0E}, {0x1F,0x01,0x02,0x04,0x08,0x08,0x08},
+  {0x0E,0x11,0x11,0x0E,0x11,0x11,0x0E}, {0x0E,0x11,0x11,0x0F,0x01,0x02,0x0C},
+};
+static const uint8_t LETTERS[26][7] = {
+  {0x0E,0x11,0x11,0x11,0x1F,0x11,0x11}, {0x1E,0x11,0x11,0x1E,0x11,0x11,0x1E}, // A B
+  {0x0E,0x11,0x10,0x10,0x10,0x11,0x0E}, {0x1C,0x12,0x11,0x11,0x11,0x12,0x1C}, // C D
+  {0x1F,0x10,0x10,0x1E,0x10,0x10,0x1F}, {0x1F,0x10,0x10,0x1E,0x10,0x10,0x10}, // E F
+  {0x0E,0x11,0x10,0x17,0x11,0x11,0x0F}, {0x11,0x11,0x11,0x1F,0x11,0x11,0x11}, // G H
+  {0x0E,0x04,0x04,0x04,0x04,0x04,0x0E}, {0x07,0x02,0x02,0x02,0x02,0x12,0x0C}, // I J
+  {0x11,0x12,0x14,0x18,0x14,0x12,0x11}, {0x10,0x10,0x10,0x10,0x10,0x10,0x1F}, // K L
+  {0x11,0x1B,0x15,0x15,0x11,0x11,0x11}, {0x11,0x11,0x19,0x15,0x13,0x11,0x11}, // M N
+  {0x0E,0x11,0x11,0x11,0x11,0x11,0x0E}, {0x1E,0x11,0x11,0x1E,0x10,0x10,0x10}, // O P
+  {0x0E,0x11,0x11,0x11,0x15,0x12,0x0D}, {0x1E,0x11,0x11,0x1E,0x14,0x12,0x11}, // Q R
+  {0x0F,0x10,0x10,0x0E,0x01,0x01,0x1E}, {0x1F,0x04,0x04,0x04,0x04,0x04,0x04}, // S T
+  {0x11,0x11,0x11,0x11,0x11,0x11,0x0E}, {0x11,0x11,0x11,0x11,0x11,0x0A,0x04}, // U V
+  {0x11,0x11,0x11,0x15,0x15,0x15,0x0A}, {0x11,0x11,0x0A,0x04,0x0A,0x11,0x11}, // W X
+  {0x11,0x11,0x11,0x0A,0x04,0x04,0x04}, {0x1F,0x01,0x02,0x04,0x08,0x10,0x1F}, // Y Z
+};
+static const uint8_t COLON[7] = {0x00,0x0C,0x0C,0x00,0x0C,0x0C,0x00};
+static const uint8_t DOT[7]   = {0x00,0x00,0x00,0x00,0x00,0x0C,0x0C};
+static const uint8_t BANG[7]  = {0x04,0x04,0x04,0x04,0x04,0x00,0x04};
+static const uint8_t DASH[7]  = {0x00,0x00,0x00,0x1F,0x00,0x00,0x00};
+static const uint8_t SLASH[7] = {0x01,0x01,0x02,0x04,0x08,0x10,0x10};
+static const uint8_t PCT[7]   = {0x18,0x19,0x02,0x04,0x08,0x13,0x03};
+
+const uint8_t* glyph5x7(char ch){
+  if(ch>='0' && ch<='9') return DIGITS[ch-'0'];
+  if(ch>='a' && ch<='z') ch = (char)(ch-'a'+'A');
+  if(ch>='A' && ch<='Z') return LETTERS[ch-'A'];
+  switch(ch){
+    case ':': return COLON; case '.': return DOT; case '!': return BANG;
+    case '-': return DASH;  case '/': return SLASH; case '%': return PCT;
+    default:  return BLANK;
+  }
+}
+
+
+// =====================================
+// File: src/glyphatlas.cpp
+// =====================================
+#include <GL/glut.h>
+#include <cstring>
+#include "glyphatlas.hpp"
+#include "font5x7.hpp"
+
+// Printable ASCII in a 16x8 grid of 8x8 cells (128x64 texels). Glyph rows go
+// in top-down, so v grows downwards inside a cell; sampling is nearest, so
+// the font stays crisp at any scale and cells never bleed into each other.
+static constexpr int ATLAS_COLS = 16, CELL = 8, ATLAS_W = ATLAS_COLS*CELL, ATLAS_H = 8*CELL;
+static constexpr char FIRST_CHAR = ' ', LAST_CHAR = '~';
+static GLuint atlasTex = 0;
+
+bool glyphAtlasInit(){
+  static unsigned char texels[ATLAS_H][ATLAS_W];
+  std::memset(texels, 0, sizeof(texels));
+  for(char ch=FIRST_CHAR; ch<=LAST_CHAR; ch++){
+    int i=ch-FIRST_CHAR, cx=(i%ATLAS_COLS)*CELL, cy=(i/ATLAS_COLS)*CELL;
+    const uint8_t* g=glyph5x7(ch);
+    for(int row=0;row<FONT_H;row++) for(int col=0;col<FONT_W;col++)
+      if(g[row] & (0x10>>col)) texels[cy+row][cx+col]=255;
+  }
+  if(!atlasTex) glGenTextures(1, &atlasTex);
+  glBindTexture(GL_TEXTURE_2D, atlasTex);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, ATLAS_W, ATLAS_H, 0, GL_ALPHA, GL_UNSIGNED_BYTE, texels);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return atlasTex!=0;
+}
+
+bool textSet(TextLabel& t, const char* s){
+  if(t.text==s) return false;
+  t.text = s; t.verts.clear();
+  int n=(int)t.text.size();
+  t.width = n ? n*FONT_ADVANCE-1 : 0;
+  for(int i=0;i<n;i++){
+    char ch=t.text[i];
+    if(ch<FIRST_CHAR || ch>LAST_CHAR || ch==' ') continue;   // blank: no quad
+    int k=ch-FIRST_CHAR;
+    float u0=(float)((k%ATLAS_COLS)*CELL)/ATLAS_W, u1=u0+(float)FONT_W/ATLAS_W;
+    float vTop=(float)((k/ATLAS_COLS)*CELL)/ATLAS_H, vBot=vTop+(float)FONT_H/ATLAS_H;
+    float x0=(float)(i*FONT_ADVANCE), x1=x0+FONT_W, y0=0.0f, y1=(float)FONT_H;
+    float q[24]={x0,y0,u0,vBot, x1,y0,u1,vBot, x1,y1,u1,vTop,  x0,y0,u0,vBot, x1,y1,u1,vTop, x0,y1,u0,vTop};
+    t.verts.insert(t.verts.end(), q, q+24);
+  }
+  return true;
+}
+
+void textDraw(const TextLabel& t, float x, float yBase, float pxSize, float r,float g,float b, float a){
+  if(t.verts.empty()) return;
+  glPushMatrix(); glTranslatef(x, yBase, 0.0f); glScalef(pxSize, pxSize, 1.0f);
+  glEnable(GL_TEXTURE_2D); glBindTexture(GL_TEXTURE_2D, atlasTex);
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+  glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glColor4f(r,g,b,a);
+  glEnableClientState(GL_VERTEX_ARRAY); glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glVertexPointer(2, GL_FLOAT, 4*sizeof(float), t.verts.data());
+  glTexCoordPointer(2, GL_FLOAT, 4*sizeof(float), t.verts.data()+2);
+  glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(t.verts.size()/4));
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY); glDisableClientState(GL_VERTEX_ARRAY);
+  glDisable(GL_BLEND); glBindTexture(GL_TEXTURE_2D, 0); glDisable(GL_TEXTURE_2D);
+  glPopMatrix();
+}
+
+
+// =====================================
+// File: src/softraster.cpp
+// =====================================
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "softraster.hpp"
+#include "font5x7.hpp"
+#include "../your-part/include/config.hpp"
+#include "../your-part/include/maze.hpp"
+#include "../your-part/include/util.hpp"
+
+using namespace pac;
+
+// View height in world units, as in reshapeView's gluOrtho2D
+static const float VIEW_H = ROWS + 1.2f;
+
+static inline uint32_t pack(float r,float g,float b){
+  auto u8=[](float v){ return (uint32_t)(std::min(1.0f,std::max(0.0f,v))*255.0f+0.5f); };
+  return u8(r) | (u8(g)<<8) | (u8(b)<<16) | 0xff000000u;
+}
+static inline uint32_t pack(RGBc c){ return pack(c.r,c.g,c.b); }
+
+void softResize(SoftCanvas& cv, int w, int h){
+  cv.w=w; cv.h=h; cv.px.assign((std::size_t)w*h, 0xff000000u);
+  cv.sx = w/(float)COLS; cv.sy = h/VIEW_H;
+  float pxPerUnit = std::min(cv.sx, cv.sy);
+  if(cv.sprites.pxPerUnit!=pxPerUnit) buildSpriteSet(cv.sprites, pxPerUnit);
+}
+
+// ===== primitives (pixel space, y down)
+static void fillRect(SoftCanvas& cv, float x0,float y0,float x1,float y1, uint32_t c){
+  int ix0=std::max(0,(int)std::lround(x0)), ix1=std::min(cv.w,(int)std::lround(x1));
+  int iy0=std::max(0,(int)std::lround(y0)), iy1=std::min(cv.h,(int)std::lround(y1));
+  for(int y=iy0;y<iy1;y++) std::fill(&cv.px[(std::size_t)y*cv.w+ix0], &cv.px[(std::size_t)y*cv.w+ix0]+std::max(0,ix1-ix0), c);
+}
+
+static void darkenRect(SoftCanvas& cv, float x0,float y0,float x1,float y1, float alpha){
+  int ix0=std::max(0,(int)std::lround(x0)), ix1=std::min(cv.w,(int)std::lround(x1));
+  int iy0=std::max(0,(int)std::lround(y0)), iy1=std::min(cv.h,(int)std::lround(y1));
+  uint32_t k=(uint32_t)((1.0f-alpha)*256.0f);
+  for(int y=iy0;y<iy1;y++) for(int x=ix0;x<ix1;x++){
+    uint32_t& p=cv.px[(std::size_t)y*cv.w+x];
+    uint32_t r=((p&0xff)*k)>>8, g=(((p>>8)&0xff)*k)>>8, b=(((p>>16)&0xff)*k)>>8;
+    p = r | (g<<8) | (b<<16) | 0xff000000u;
+  }
+}
+
+// Edge-function fill sampled at pixel centers; either winding is accepted
+static void fillTri(SoftCanvas& cv, float x0,float y0,float x1,float y1,float x2,float y2, uint32_t c){
+  float area=(x1-x0)*(y2-y0)-(y1-y0)*(x2-x0);
+  if(area==0.0f) return;
+  if(area<0.0f){ std::swap(x1,x2); std::swap(y1,y2); }
+  int minX=std::max(0,(int)std::floor(std::min({x0,x1,x2}))), maxX=std::min(cv.w-1,(int)std::ceil(std::max({x0,x1,x2})));
+  int minY=std::max(0,(int)std::floor(std::min({y0,y1,y2}))), maxY=std::min(cv.h-1,(int)std::ceil(std::max({y0,y1,y2})));
+  if(minX>maxX || minY>maxY) return;
+  // e_i(px,py) = A_i*px + B_i*py + C_i, stepping +A_i per pixel along a row
+  float A0=y1-y2, A1=y2-y0, A2=y0-y1;
+  float px0=minX+0.5f;
+  for(int y=minY;y<=maxY;y++){
+    float py=y+0.5f;
+    float e0=(x2-x1)*(py-y1)-(y2-y1)*(px0-x1), e1=(x0-x2)*(py-y2)-(y0-y2)*(px0-x2), e2=(x1-x0)*(py-y0)-(y1-y0)*(px0-x0);
+    uint32_t* row=&cv.px[(std::size_t)y*cv.w];
+    for(int x=minX;x<=maxX;x++){
+      if(e0>=0.0f && e1>=0.0f && e2>=0.0f) row[x]=c;
+      e0+=A0; e1+=A1; e2+=A2;
+    }
+  }
+}
+
+static void fillEllipse(SoftCanvas& cv, float cx,float cy,float rx,float ry, uint32_t c){
+  int y0=std::max(0,(int)std::floor(cy-ry)), y1=std::min(cv.h-1,(int)std::ceil(cy+ry));
+  for(int y=y0;y<=y1;y++){
+    float t=(y+0.5f-cy)/ry; if(t*t>1.0f) continue;
+    float half=rx*std::sqrt(1.0f-t*t);
+    fillRect(cv, cx-half, (float)y, cx+half, (float)y+1, c);
+  }
+}
+
+static void drawText(SoftCanvas& cv, const char* s, float x,float yBase, int scale, uint32_t c){
+  int top=(int)std::lround(yBase)-FONT_H*scale;
+  for(int i=0; s[i]; i++){
+    const uint8_t* g=glyph5x7(s[i]);
+    int gx=(int)std::lround(x)+i*FONT_ADVANCE*scale;
+    for(int row=0;row<FONT_H;row++) for(int col=0;col<FONT_W;col++)
+      if(g[row] & (0x10>>col)) fillRect(cv, (float)gx+col*scale, (float)top+row*scale, (float)gx+(col+1)*scale, (float)top+(row+1)*scale, c);
+  }
+}
+
+// ===== world-space helpers
+static inline float toPxX(const SoftCanvas& cv, float x){ return x*cv.sx; }
+static inline float toPxY(const SoftCanvas& cv, float y){ return cv.h - y*cv.sy; }
+
+static void drawSprite(SoftCanvas& cv, const SpriteMesh& m, float cx,float cy, float angleDeg=0.0f, const RGBc* tint=nullptr){
+  float a=angleDeg*3.14159265f/180.0f, ca=std::cos(a), sa=std::sin(a);
+  const float* xy=cv.sprites.xy.data();
+  for(const MeshPart& p : m.parts){
+    uint32_t c = pack((p.tint && tint) ? *tint : p.col);
+    for(int i=p.first;i<p.first+p.count;i+=3){
+      float v[6];
+      for(int k=0;k<3;k++){
+        float lx=xy[(i+k)*2], ly=xy[(i+k)*2+1];
+        v[k*2]   = toPxX(cv, cx + lx*ca - ly*sa);
+        v[k*2+1] = toPxY(cv, cy + lx*sa + ly*ca);
+      }
+      fillTri(cv, v[0],v[1],v[2],v[3],v[4],v[5], c);
+    }
+  }
+}
+
+static int textScale(const SoftCanvas& cv, float worldH){ return std::max(1,(int)std::lround(worldH*cv.sy/FONT_H)); }
+
+void softRenderMaze(SoftCanvas& cv, const World& world){
+  std::fill(cv.px.begin(), cv.px.end(), pack(BG_COL));
+  uint32_t wallC=pack(WALL_COL), dotC=pack(DOT_COL);
+  const BitBoard& blocked = levelOf(world).planes().pacBlocked;
+  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++){
+    float x=c, y=(ROWS-1-r);
+    if(blocked.test(r,c)) fillRect(cv, toPxX(cv,x+0.06f), toPxY(cv,y+0.94f), toPxX(cv,x+0.94f), toPxY(cv,y+0.06f), wallC);
+    else if(world.pellets.test(r,c)) fillEllipse(cv, toPxX(cv,x+0.5f), toPxY(cv,y+0.5f), 0.08f*cv.sx, 0.08f*cv.sy, dotC);
+  }
+}
+
+void softRenderActors(SoftCanvas& cv, const World& world){
+  drawSprite(cv, cv.sprites.pac, world.pacman.x, world.pacman.y, world.rt.pacAngleDeg);
+  RGBc gc[4]={BLINKY_COL,PINKY_COL,INKY_COL,CLYDE_COL};
+  for(int i=0;i<4;i++) drawSprite(cv, cv.sprites.ghost, world.ghosts[i].x, world.ghosts[i].y, 0.0f, &gc[i]);
+}
+
+void softRenderSupers(SoftCanvas& cv, const World& world){
+  for(int i=0;i<MAX_SUPERS;i++) if(world.supers[i].active) drawSprite(cv, cv.sprites.melon, cellCenterX(world.supers[i].c), cellCenterY(world.supers[i].r));
+}
+
+void softRenderHeart(SoftCanvas& cv, const World& world){
+  if(world.heart.active) drawSprite(cv, cv.sprites.heart, cellCenterX(world.heart.c), cellCenterY(world.heart.r));
+}
+
+void softRenderHUD(SoftCanvas& cv, const World& world){
+  const Runtime& RT=world.rt; char buf[128];
+  std::snprintf(buf,sizeof(buf),"SCORE:%d  LIVES:%d  TIME:%.1fs", RT.score, RT.lives, RT.simTime);
+  drawText(cv, buf, toPxX(cv,0.6f), toPxY(cv,ROWS+0.3f), textScale(cv,0.40f), pack(HUD_COL));
+  if(RT.paused && !RT.winGame && !RT.gameOver) drawText(cv, "PAUSED", toPxX(cv,8), toPxY(cv,10), textScale(cv,0.5f), pack(1,1,1));
+  if(RT.winGame) drawText(cv, "YOU WIN!", toPxX(cv,8), toPxY(cv,10), textScale(cv,0.5f), pack(1,1,0));
+}
+
+// Dark band + GAME OVER fitted to 88% of the band width
+void softRenderGameOverOverlay(SoftCanvas& cv){
+  float yMid=ROWS*0.55f, x0=2.0f, x1=COLS-2.0f;
+  darkenRect(cv, toPxX(cv,x0), toPxY(cv,yMid+1.2f), toPxX(cv,x1), toPxY(cv,yMid-1.2f), 0.55f);
+  const char* msg="GAME OVER"; int len=(int)std::strlen(msg);
+  float targetPx=(x1-x0)*0.88f*cv.sx; int s=std::max(1,(int)(targetPx/(len*FONT_ADVANCE-1)));
+  float tx=(cv.w - (len*FONT_ADVANCE-1)*s)*0.5f, ty=toPxY(cv,yMid)+FONT_H*s*0.5f;
+  drawText(cv, msg, tx+s, ty+s, s, pack(0,0,0));
+  drawText(cv, msg, tx, ty, s, pack(1,1,1));
+}
+
+void softRenderGame(SoftCanvas& cv, const World& world){
+  softRenderMaze(cv, world);
+  softRenderActors(cv, world);
+  softRenderSupers(cv, world);
+  softRenderHeart(cv, world);
+  softRenderHUD(cv, world);
+  if(world.rt.gameOver) softRenderGameOverOverlay(cv);
+}
+
+bool softWritePPM(const SoftCanvas& cv, const char* path){
+  std::FILE* f=std::fopen(path,"wb"); if(!f) return false;
+  std::fprintf(f,"P6\n%d %d\n255\n",cv.w,cv.h);
+  std::vector<unsigned char> row((std::size_t)cv.w*3);
+  for(int y=0;y<cv.h;y++){
+    for(int x=0;x<cv.w;x++){ uint32_t p=cv.px[(std::size_t)y*cv.w+x]; row[x*3]=p&0xff; row[x*3+1]=(p>>8)&0xff; row[x*3+2]=(p>>16)&0xff; }
+    std::fwrite(row.data(),1,row.size(),f);
+  }
+  return std::fclose(f)==0;
+}
+
+
+// =====================================
+// File: src/thumbs.cpp
+// =====================================
+// Offscreen render driver: plays one seeded autopilot game on the simulated
+// clock and draws it with the software rasterizer at 60 fps of game time.
+// Every Nth frame can be written as a PPM thumbnail; render throughput is
+// reported either way. No display or GL context needed.
+// Usage: pac_thumbs [seed=1] [w=380] [h=410] [every=60] [outdir]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "softraster.hpp"
+#include "../your-part/include/autopilot.hpp"
+#include "../your-part/include/config.hpp"
+#include "../your-part/include/logic.hpp"
+#include "../your-part/include/util.hpp"
+
+using namespace pac;
+
+// Cap so a stuck autopilot can't render forever
+static constexpr float MAX_GAME_S = 600.0f;
+// Simulated ticks between rendered frames (60 fps at SIM_DT)
+static constexpr int TICKS_PER_FRAME = 2;
+
+int main(int argc,char** argv){
+  unsigned long long seed = argc>1 ? std::strtoull(argv[1],nullptr,10) : 1ull;
+  int w = argc>2 ? std::atoi(argv[2]) : 380, h = argc>3 ? std::atoi(argv[3]) : 410;
+  int every = argc>4 ? std::atoi(argv[4]) : 60;
+  const char* outdir = argc>5 ? argv[5] : nullptr;
+  w=std::max(w,16); h=std::max(h,16); every=std::max(every,1);
+
+  static World world; seedRng(world, seed); startNewGame(world);
+  SoftCanvas cv; softResize(cv, w, h);
+
+  using Clock = std::chrono::steady_clock;
+  double renderSecs=0.0; int frames=0, written=0;
+  while(world.rt.simTime<MAX_GAME_S){
+    auto t0=Clock::now();
+    softRenderGame(cv, world);
+    renderSecs += std::chrono::duration<double>(Clock::now()-t0).count(); frames++;
+    if(outdir && (frames-1)%every==0){
+      char path[512]; std::snprintf(path,sizeof(path),"%s/frame_%05d.ppm",outdir,frames);
+      if(softWritePPM(cv,path)) written++;
+      else { std::fprintf(stderr,"pac_thumbs: cannot write %s\n",path); return 1; }
+    }
+    if(world.rt.gameOver || world.rt.winGame) break;
+    for(int t=0;t<TICKS_PER_FRAME && !world.rt.gameOver && !world.rt.winGame;t++){ autopilotRandomWalk(world); step(world, SIM_DT); }
+  }
+
+  std::printf("seed=%llu size=%dx%d frames=%d written=%d score=%d sim=%.1fs\n",
+              seed, w, h, frames, written, world.rt.score, world.rt.simTime);
+  std::printf("render=%.3fs fps=%.0f ms/frame=%.3f\n",
+              renderSecs, renderSecs>0.0 ? frames/renderSecs : 0.0, frames ? 1000.0*renderSecs/frames : 0.0);
+  return 0;
+}
+
+
+// =====================================
+// File: src/bench.cpp
+// =====================================
+// Microbenchmarks for the core tick and the render passes. The render cases
+// (softraster/*) time the software rasterizer, the offscreen stand-in for the
+// GL renderer: renderMaze() and the other GL passes draw through GLUT and need
+// a window, so they are not timed here. The output says so too.
+// Every case starts from the same seeded mid-game world, so runs are
+// repeatable. Results print as a table and optionally go to CSV/JSON; with
+// --baseline, each case is compared to a saved CSV and the run fails when a
+// median gets slower than --threshold percent.
+// Usage: pac_bench [--filter S] [--csv out.csv] [--json out.json]
+//                  [--baseline base.csv] [--threshold 10]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "softraster.hpp"
+#include "../your-part/include/autopilot.hpp"
+#include "../your-part/include/logic.hpp"
+#include "../your-part/include/maze.hpp"
+#include "../your-part/include/mcts.hpp"
+#include "../your-part/include/powerups.hpp"
+#include "../your-part/include/rewind.hpp"
+#include "../your-part/include/util.hpp"
+
+using namespace pac;
+using Clock = std::chrono::steady_clock;
+
+// Keeps a result alive without the compiler proving it unused
+template<class T> static inline void keep(const T& v){
+#if defined(__GNUC__)
+  asm volatile("" : : "g"(&v) : "memory");
+#else
+  static volatile const void* sink; sink=&v;
+#endif
+}
+
+static constexpr int    SAMPLES      = 21;
+static constexpr double SAMPLE_SECS  = 0.005;  // target length of one sample
+static constexpr int    WARMUP_TICKS = 600;    // five simulated seconds into a game
+static constexpr int    RESTORE_EVERY = 120;   // stateful cases rewind to the snapshot every simulated second
+
+struct Result { std::string name; long long iters; double medianNs, minNs, p90Ns; };
+
+// Seeded game advanced a few seconds with the autopilot: pellets partly eaten,
+// ghosts out of the pen, powerups on the board
+static World makeSnapshot(){
+  World w; seedRng(w, 1); startNewGame(w);
+  for(int t=0;t<WARMUP_TICKS;t++){ autopilotRandomWalk(w); step(w, SIM_DT); }
+  return w;
+}
+
+// All but one super slot and the heart taken, so the spawner's rejection loop
+// has the most to dodge and every render pass has something to draw
+static World makeCrowded(const World& snap){
+  World w=snap; resetSupers(w); resetHeart(w);
+  for(int i=0;i<MAX_SUPERS-1;i++) maybeSpawnSupers(w, SUPER_SPAWN_INTERVAL*(i+1));
+  maybeSpawnHeart(w, HEART_SPAWN_INTERVAL);
+  return w;
+}
+
+template<class F> static Result runCase(const char* name, F&& op){
+  auto timeIters=[&](long long n){ auto t0=Clock::now(); for(long long i=0;i<n;i++) op(i); return std::chrono::duration<double>(Clock::now()-t0).count(); };
+  long long iters=1; double t=timeIters(iters);
+  while(t<SAMPLE_SECS*0.2 && iters<(1LL<<40)){ iters*=2; t=timeIters(iters); }
+  iters=std::max(1LL,(long long)(iters*SAMPLE_SECS/std::max(t,1e-9)));
+  std::vector<double> ns(SAMPLES);
+  for(double& s:ns) s=timeIters(iters)*1e9/iters;
+  std::sort(ns.begin(), ns.end());
+  return Result{name, iters, ns[SAMPLES/2], ns[0], ns[SAMPLES*9/10]};
+}
+
+// ===== output
+static void writeCSV(const char* path, const std::vector<Result>& rs){
+  std::FILE* f=std::fopen(path,"w"); if(!f){ std::fprintf(stderr,"pac_bench: cannot write %s\n",path); return; }
+  std::fprintf(f,"name,iters,median_ns,min_ns,p90_ns\n");
+  for(const Result& r:rs) std::fprintf(f,"%s,%lld,%.2f,%.2f,%.2f\n",r.name.c_str(),r.iters,r.medianNs,r.minNs,r.p90Ns);
+  std::fclose(f);
+}
+static void writeJSON(const char* path, const std::vector<Result>& rs){
+  std::FILE* f=std::fopen(path,"w"); if(!f){ std::fprintf(stderr,"pac_bench: cannot write %s\n",path); return; }
+  std::fprintf(f,"{\"samples\":%d,\"results\":[\n",SAMPLES);
+  for(std::size_t i=0;i<rs.size();i++)
+    std::fprintf(f,"  {\"name\":\"%s\",\"iters\":%lld,\"median_ns\":%.2f,\"min_ns\":%.2f,\"p90_ns\":%.2f}%s\n",
+                 rs[i].name.c_str(),rs[i].iters,rs[i].medianNs,rs[i].minNs,rs[i].p90Ns,i+1<rs.size()?",":"");
+  std::fprintf(f,"]}\n"); std::fclose(f);
+}
+static std::map<std::string,double> readBaseline(const char* path){
+  std::map<std::string,double> m; std::FILE* f=std::fopen(path,"r");
+  if(!f){ std::fprintf(stderr,"pac_bench: no baseline at %s\n",path); return m; }
+  char line[256]; std::fgets(line,sizeof(line),f); // header
+  while(std::fgets(line,sizeof(line),f)){
+    char name[128]; long long it; double med;
+    if(std::sscanf(line,"%127[^,],%lld,%lf",name,&it,&med)==3) m[name]=med;
+  }
+  std::fclose(f); return m;
+}
+
+int main(int argc,char** argv){
+  const char *filter=nullptr, *csv=nullptr, *json=nullptr, *baseline=nullptr; double threshold=10.0;
+  for(int i=1;i<argc;i++){
+    auto arg=[&](const char* k){ return std::strcmp(argv[i],k)==0 && i+1<argc; };
+    if(arg("--filter")) filter=argv[++i];
+    else if(arg("--csv")) csv=argv[++i];
+    else if(arg("--json")) json=argv[++i];
+    else if(arg("--baseline")) baseline=argv[++i];
+    else if(arg("--threshold")) threshold=std::atof(argv[++i]);
+    else { std::fprintf(stderr,"usage: pac_bench [--filter S] [--csv F] [--json F] [--baseline F] [--threshold PCT]\n"); return 2; }
+  }
+
+  const World snap=makeSnapshot();
+  std::vector<Result> results;
+  auto bench=[&](const char* name, auto&& op){
+    if(filter && !std::strstr(name,filter)) return;
+    results.push_back(runCase(name, op));
+    const Result& r=results.back();
+    std::printf("%-28s %12.1f ns/op  (min %.1f, p90 %.1f, %lld iters)\n", r.name.c_str(), r.medianNs, r.minNs, r.p90Ns, r.iters);
+    std::fflush(stdout);
+  };
+
+  // ===== core
+  { World w=snap;
+    bench("core/step", [&](long long i){ if(i%RESTORE_EVERY==0) w=snap; step(w, SIM_DT); keep(w); }); }
+  { World w=snap;
+    bench("core/updateGhosts", [&](long long i){ if(i%RESTORE_EVERY==0) w=snap; updateGhosts(w, SIM_DT); keep(w); }); }
+  { World w=snap;
+    int cell[4][2]; for(int g=0;g<4;g++){ cell[g][0]=yToRow(w.ghosts[g].y); cell[g][1]=xToCol(w.ghosts[g].x); }
+    bench("core/chooseGhostDirWithChase", [&](long long i){ int g=(int)(i&3); chooseGhostDirWithChase(w,g,cell[g][0],cell[g][1]); keep(w.gDx); }); }
+  // Cloning a world for search/rollback, and one rewind-history capture
+  { World w;
+    bench("core/snapshotCopy", [&](long long){ w=snap; keep(w); }); }
+  { RewindBuffer hist;
+    bench("core/rewindPush", [&](long long){ hist.push(snap); keep(hist); }); }
+  { bench("core/countDots", [&](long long){ int n=countDots(snap); keep(n); }); }
+  { World w=snap;
+    bench("core/copyMazeFromTemplate", [&](long long){ copyMazeFromTemplate(w); keep(w.pellets); }); }
+  // One autopilot decision at a fixed iteration count on one thread
+  { MctsConfig cfg; cfg.budgetMs=0.0f; cfg.maxIterations=64; MctsPlanner pl(cfg, 1);
+    bench("core/mctsDecide64", [&](long long i){ int d=pl.decide(snap, (uint64_t)i); keep(d); }); }
+  // The new super is cleared after each spawn so the board stays crowded
+  { World w=makeCrowded(snap);
+    bench("core/spawnOneSuper_crowded", [&](long long){
+      w.rt.lastSuperSpawnAt=0.0f; maybeSpawnSupers(w, SUPER_SPAWN_INTERVAL);
+      w.supers[MAX_SUPERS-1].active=false; keep(w.supers); }); }
+
+  // ===== render (software backend at the default 760x820 window)
+  std::printf("softraster/*: software rasterizer passes, standing in for the GL render*() functions (those need a GLUT window)\n");
+  SoftCanvas cv; softResize(cv, 760, 820);
+  World rw=makeCrowded(snap); maybeSpawnSupers(rw, SUPER_SPAWN_INTERVAL*MAX_SUPERS); rw.rt.gameOver=true;
+  bench("softraster/maze",     [&](long long){ softRenderMaze(cv, rw); keep(cv.px[0]); });
+  bench("softraster/actors",   [&](long long){ softRenderActors(cv, rw); keep(cv.px[0]); });
+  bench("softraster/supers",   [&](long long){ softRenderSupers(cv, rw); keep(cv.px[0]); });
+  bench("softraster/heart",    [&](long long){ softRenderHeart(cv, rw); keep(cv.px[0]); });
+  bench("softraster/hud",      [&](long long){ softRenderHUD(cv, rw); keep(cv.px[0]); });
+  bench("softraster/gameOver", [&](long long){ softRenderGameOverOverlay(cv); keep(cv.px[0]); });
+  bench("softraster/frame",    [&](long long){ softRenderGame(cv, rw); keep(cv.px[0]); });
+
+  if(csv) writeCSV(csv, results);
+  if(json) writeJSON(json, results);
+
+  int regressions=0;
+  if(baseline){
+    std::map<std::string,double> base=readBaseline(baseline);
+    if(base.empty()) return 1;   // nothing to compare against is a failed check, not a pass
+    std::printf("\n%-28s %12s %12s %8s\n","vs baseline","base ns","now ns","delta");
+    for(const Result& r:results){
+      auto it=base.find(r.name); if(it==base.end() || it->second<=0.0) continue;
+      double d=(r.medianNs-it->second)/it->second*100.0; bool slow=d>threshold;
+      regressions+=slow;
+      std::printf("%-28s %12.1f %12.1f %+7.1f%%%s\n", r.name.c_str(), it->second, r.medianNs, d, slow?"  REGRESSION":"");
+    }
+    std::printf("%d regression(s) over %.0f%%\n", regressions, threshold);
+  }
+  return regressions ? 1 : 0;
+}
+
+
+// =====================================
+// File: bench/baseline.csv
+// =====================================
+name,iters,median_ns,min_ns,p90_ns
+core/step,20398,232.21,220.97,241.26
+core/updateGhosts,30647,167.45,157.61,173.58
+core/chooseGhostDirWithChase,192361,26.36,23.83,29.95
+core/snapshotCopy,112434,19.96,19.02,21.58
+core/rewindPush,183306,26.46,25.67,28.09
+core/countDots,154685,32.72,32.01,33.34
+core/copyMazeFromTemplate,1219010,4.37,4.28,4.61
+core/mctsDecide64,1,3022557.00,2683509.00,3181283.00
+core/spawnOneSuper_crowded,65669,69.37,64.84,73.70
+softraster/maze,18,284643.72,254920.50,367697.67
+softraster/actors,114,43423.83,35859.00,45478.33
+softraster/supers,277,18284.36,17220.55,19105.78
+softraster/heart,1219,4171.58,3811.97,4892.77
+softraster/hud,405,12027.86,11507.32,12944.32
+softraster/gameOver,23,214351.13,207388.52,228038.83
+softraster/frame,6,646120.00,511930.17,704350.00
+
+
+// =====================================
+// File: src/simthread.cpp
+// =====================================
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include "simthread.hpp"
+
+#include "../your-part/include/handoff.hpp"
+#include "../your-part/include/maze.hpp"
+#include "../your-part/include/mcts.hpp"
+#include "../your-part/include/powerups.hpp"
+#include "../your-part/include/replay.hpp"
+#include "../your-part/include/rewind.hpp"
+#include "../your-part/include/util.hpp"
+
+using namespace pac;
+using Clock = std::chrono::steady_clock;
+
+// Wall-clock lag after which the thread stops catching up (e.g. after a suspend)
+static constexpr auto MAX_LAG = std::chrono::milliseconds(250);
+
+static TripleBuffer<SimFrame>    frames;
+static SpscQueue<InputCode, 256> inputs;
+static std::thread               simThread;
+static std::atomic<bool>         running{false};
+static std::atomic<bool>         autopilot{false};
+static unsigned                  gamesPosted = 0;
+static unsigned long long        inputsPosted = 0;
+
+// Owned by the simulation thread while it runs
+static World          live;
+static RewindBuffer   history;
+static InputRecorder  recorder;
+static unsigned long long simTick = 0;
+static unsigned       gamesApplied = 0;
+static unsigned long long inputsApplied = 0;
+static std::unique_ptr<MctsPlanner> planner;   // built on first use: worker threads + node pools
+// The planner runs inline, so a decision must end within half a tick; one
+// that would not fit is skipped and tried again on the next tick
+static constexpr float PLANNER_BUDGET_MS = 0.25f*SIM_DT*1000.0f;
+
+// Same order as runReplay(): inputs due at this tick, then one step while a
+// game is on screen. The post-game menu is reached when the hold ends.
+// Between games nothing changes without an input, so nothing is published.
+static void simLoop(){
+  bool playing = false;
+  auto next = Clock::now();
+  const auto tickDur = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(SIM_DT));
+  while(running.load(std::memory_order_relaxed)){
+    InputCode in; bool changed = playing;
+    while(inputs.pop(in)){
+      recorder.record(simTick, in);
+      applyInput(live, history, in);
+      inputsApplied++; changed = true;
+      if(in==IN_NEW_GAME){ playing = true; gamesApplied++; }
+    }
+    if(playing && autopilot.load(std::memory_order_relaxed)){
+      if(!planner){ MctsConfig cfg; cfg.budgetMs = PLANNER_BUDGET_MS; planner.reset(new MctsPlanner(cfg)); }
+      in = planner->poll(live, simTick, next + tickDur/2);
+      if(in!=IN_COUNT){ recorder.record(simTick, in); applyInput(live, history, in); }
+    }
+    if(changed){
+      SimFrame& f = frames.writeBuffer();
+      f.prevPacman = live.pacman;
+      for(int i=0;i<4;i++) f.prevGhosts[i] = live.ghosts[i];
+      if(playing){
+        step(live, SIM_DT); simTick++;
+        recorder.noteTick(simTick);
+        history.onStep(live, simTick);
+        if(finishGameOverHold(live)) playing = false;
+      }
+      f.world = live; f.at = next; f.tick = simTick; f.games = gamesApplied; f.inputs = inputsApplied;
+      frames.publish();
+    }
+
+    next += tickDur;
+    auto now = Clock::now();
+    if(now - next > MAX_LAG) next = now;
+    std::this_thread::sleep_until(next);
+  }
+}
+
+void simStart(unsigned long long seed, const char* recPath, int level){
+  // Same setup as runReplay(), so recorded sessions replay exactly
+  seedRng(live, seed); live.level = (uint16_t)level;
+  copyMazeFromTemplate(live);
+  resetSupers(live); resetHeart(live);
+  if(recPath && !recorder.open(recPath, seed, level)) std::fprintf(stderr, "cannot record to %s\n", recPath);
+  SimFrame& f = frames.writeBuffer();
+  f.world = live; f.prevPacman = live.pacman;
+  for(int i=0;i<4;i++) f.prevGhosts[i] = live.ghosts[i];
+  f.at = Clock::now(); frames.publish();
+  running = true;
+  simThread = std::thread(simLoop);
+}
+
+void simStop(){
+  if(!simThread.joinable()) return;
+  running = false;
+  simThread.join();
+  recorder.close(simTick);
+}
+
+void simPost(InputCode in){
+  if(!inputs.push(in)){ std::fprintf(stderr, "input queue full, dropped input %d\n", (int)in); return; }
+  inputsPosted++;
+  if(in==IN_NEW_GAME) gamesPosted++;
+}
+
+const SimFrame& simLatest(){ frames.update(); return frames.read(); }
+unsigned simGamesPosted(){ return gamesPosted; }
+unsigned long long simInputsPosted(){ return inputsPosted; }
+void simSetAutopilot(bool on){ autopilot = on; }
+bool simAutopilot(){ return autopilot.load(std::memory_order_relaxed); }
+
+static Actor lerpActor(const Actor& a, const Actor& b, float t){
+  Actor r = b;
+  float dx = b.x-a.x, dy = b.y-a.y;
+  if(dx*dx+dy*dy < 1.0f){ r.x = a.x + dx*t; r.y = a.y + dy*t; }
+  return r;
+}
+
+void simInterpolate(const SimFrame& f, Clock::time_point now, Actor& pacman, Actor ghosts[4]){
+  float t = std::chrono::duration<float>(now - f.at).count() / SIM_DT;
+  t = t<0.0f ? 0.0f : (t>1.0f ? 1.0f : t);
+  pacman = lerpActor(f.prevPacman, f.world.pacman, t);
+  for(int i=0;i<4;i++) ghosts[i] = lerpActor(f.prevGhosts[i], f.world.ghosts[i], t);
+}
+
+
+// =====================================
+// File: src/redraw.cpp
+// =====================================
+#include <GL/glut.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include "redraw.hpp"
+#include "state.hpp"
+#include "simthread.hpp"
+#include "glbuf.hpp"
+
+#include "../your-part/include/profile.hpp"
+
+using namespace pac;
+
+// With vsync the swap waits for the display refresh, so the idle callback just
+// redraws back to back and each frame shows the freshest tick. Without it,
+// redraws follow an absolute --fps schedule, which does not drift the way
+// chained glutTimerFunc(16) calls do.
+using Clock = std::chrono::steady_clock;
+static bool vsync = false;
+static bool pending = false;       // a redisplay is posted and not drawn yet
+static bool active = false;        // idle callback installed / timer chain running
+static bool timerArmed = false;    // GLUT timers cannot be cancelled; at most one in flight
+static int  settle = 0;            // frames still to draw once the scene stops
+static Clock::duration framePeriod;
+static Clock::time_point nextFrame;
+// Back-to-back frames timed before trusting vsync; faster than this per frame
+// means the driver accepted the swap interval but is not blocking on it
+static constexpr int   VSYNC_PROBE_FRAMES = 60;
+static constexpr float VSYNC_MIN_FRAME_S  = 0.002f;
+
+// The simulation publishes every tick even while paused (its clock runs for
+// the game-over hold), so stillness is judged from the state, not the frames.
+// Waiting on posted inputs covers the tick between a key press and the
+// snapshot that shows it.
+static bool animating(){
+  if(showProfiler || profileCapturing()) return true;
+  if(gState!=GameState::PLAYING) return false;
+  const SimFrame& f = simLatest();
+  if(f.inputs != simInputsPosted()) return true;
+  const Runtime& rt = f.world.rt;
+  return !rt.paused || (rt.gameOver && !rt.postMenuShown);
+}
+
+static void idleCB(){ requestRedraw(); }
+
+static void timerCB(int){
+  timerArmed = false;
+  if(!active) return;
+  requestRedraw();
+  auto now = Clock::now();
+  nextFrame += framePeriod;
+  if(now - nextFrame > framePeriod) nextFrame = now + framePeriod;   // fell behind or woke from idle: skip, don't burst
+  int ms = (int)std::lround(std::chrono::duration<double,std::milli>(nextFrame - now).count());
+  timerArmed = true; glutTimerFunc(ms>0 ? ms : 0, timerCB, 0);
+}
+
+static void setActive(bool on){
+  if(on==active) return;
+  active = on;
+  if(vsync){ glutIdleFunc(on ? idleCB : nullptr); return; }
+  if(on && !timerArmed){ nextFrame = Clock::now(); timerArmed = true; glutTimerFunc(0, timerCB, 0); }
+}
+
+void redrawStart(bool wantVsync, double fps){
+  if(fps < 1.0) fps = 60.0;
+  framePeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0/fps));
+  vsync = wantVsync && glSetSwapInterval(1);
+  requestRedraw();
+}
+
+void requestRedraw(){
+  if(pending) return;
+  pending = true; glutPostRedisplay();
+}
+
+void redrawFrameDone(){
+  pending = false;
+  bool anim = animating();
+  // Only consecutive animated frames say anything about vsync
+  static int probed = 0; static bool chained = false; static Clock::time_point probeStart;
+  if(vsync && probed <= VSYNC_PROBE_FRAMES){
+    if(!chained){ probed = 0; probeStart = Clock::now(); }
+    else if(probed==VSYNC_PROBE_FRAMES && std::chrono::duration<float>(Clock::now()-probeStart).count() < VSYNC_MIN_FRAME_S*VSYNC_PROBE_FRAMES){
+      std::fprintf(stderr, "vsync not honoured, pacing with a timer\n");
+      setActive(false); vsync = false;
+    }
+    probed++;
+  }
+  chained = anim;
+  // One more frame after the scene stops, so the last one drawn is the settled state
+  if(anim) settle = 1; else if(settle > 0){ settle--; anim = true; }
+  setActive(anim);
+}
+
+
+// =====================================
+// File: src/bigview.cpp
+// =====================================
+#include <GL/glut.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "bigview.hpp"
+#include "glbuf.hpp"
+#include "glyphatlas.hpp"
+#include "font5x7.hpp"
+#include "sprites.hpp"
+
+#include "../your-part/include/bigmaze.hpp"
+#include "../your-part/include/bitboard.hpp"
+#include "../your-part/include/config.hpp"
+
+using namespace pac;
+using Clock = std::chrono::steady_clock;
+
+// Cells across the shorter window side
+static constexpr float VIEW_CELLS = 32.0f;
+// Chunk meshes kept on the GPU; one view touches at most a handful
+static constexpr int CACHE_SLOTS = 32;
+static constexpr float HUD_H = 1.2f;   // HUD band on top, in cells
+
+static BigSim sim;
+static float pxPerUnit = 24.0f, viewW = VIEW_CELLS, viewH = VIEW_CELLS;
+static float camX0 = 0.0f, camY0 = 0.0f;           // bottom-left of the view, world units (y up)
+static Clock::time_point lastTick; static float acc = 0.0f;
+static int chunksDrawn = 0;
+static SpriteSet sprites; static VertexBuffer spriteBuf;
+static TextLabel hudLine;
+
+// Rows grow downwards in BigSim; the view flips them so y points up like the stock game
+static inline float worldY(float r){ return (float)sim.maze().rows() - r; }
+
+// ===== chunk meshes: wall runs merged per row, pellets as one point batch
+struct ChunkMesh { int id = -1; uint32_t pelletVersion = 0; long long lastUsed = 0; VertexBuffer walls, dots; };
+static ChunkMesh cache[CACHE_SLOTS];
+static long long frameNo = 0;
+
+static void buildWalls(ChunkMesh& s, int cr, int cc){
+  static float xy[CHUNK*CHUNK*12]; int n=0;
+  const ChunkedMaze& m=sim.maze(); const MazeChunk& k=m.chunk(cr,cc);
+  int cols=std::min(CHUNK, m.cols()-cc*CHUNK), rows=std::min(CHUNK, m.rows()-cr*CHUNK);
+  uint64_t valid = cols==64 ? ~0ull : (1ull<<cols)-1;
+  for(int lr=0; lr<rows; lr++){
+    uint64_t w=k.walls[lr]&valid; float y0=worldY((float)(cr*CHUNK+lr+1))+0.06f, y1=worldY((float)(cr*CHUNK+lr))-0.06f;
+    while(w){
+      int a=ctz64(w); uint64_t rest=~(w>>a); int len = rest ? ctz64(rest) : 64-a;
+      float x0=(float)(cc*CHUNK+a)+0.06f, x1=(float)(cc*CHUNK+a+len)-0.06f;
+      float q[12]={x0,y0, x1,y0, x1,y1,  x0,y0, x1,y1, x0,y1};
+      for(float f:q) xy[n++]=f;
+      w &= len==64 ? 0 : ~(((1ull<<len)-1)<<a);
+    }
+  }
+  glbufUpload(s.walls, xy, n/2);
+}
+
+static void buildDots(ChunkMesh& s, int cr, int cc){
+  static float xy[CHUNK*CHUNK*2]; int n=0;
+  const MazeChunk& k=sim.maze().chunk(cr,cc);
+  for(int lr=0; lr<CHUNK; lr++) for(uint64_t p=k.pellets[lr]; p; p&=p-1){
+    int lc=ctz64(p);
+    xy[n*2]=(float)(cc*CHUNK+lc)+0.5f; xy[n*2+1]=worldY((float)(cr*CHUNK+lr)+0.5f); n++;
+  }
+  glbufUpload(s.dots, xy, n, true);
+  s.pelletVersion=k.version;
+}
+
+// Cached mesh for a chunk; the least recently drawn slot is rebuilt on a miss
+static ChunkMesh& meshFor(int cr, int cc){
+  int id=cr*sim.maze().chunkCols()+cc; ChunkMesh* victim=&cache[0];
+  for(ChunkMesh& s : cache){
+    if(s.id==id){ victim=&s; break; }
+    if(s.lastUsed<victim->lastUsed) victim=&s;
+  }
+  ChunkMesh& s=*victim;
+  if(s.id!=id){ s.id=id; buildWalls(s, cr, cc); buildDots(s, cr, cc); }
+  else if(s.pelletVersion!=sim.maze().chunk(cr,cc).version) buildDots(s, cr, cc);
+  s.lastUsed=frameNo;
+  return s;
+}
+
+static void drawSprite(const SpriteMesh& m, float x, float y, float angleDeg, const RGBc* tint){
+  glPushMatrix(); glTranslatef(x, y, 0.0f);
+  if(angleDeg!=0.0f) glRotatef(angleDeg, 0.0f, 0.0f, 1.0f);
+  for(const MeshPart& p : m.parts){
+    const RGBc& c = (p.tint && tint) ? *tint : p.col;
+    glColor3f(c.r,c.g,c.b); glDrawArrays(GL_TRIANGLES, p.first, p.count);
+  }
+  glPopMatrix();
+}
+
+// ===== camera and frame
+static void followPacman(){
+  const BigActor& p=sim.pacman(); const ChunkedMaze& m=sim.maze();
+  float px=p.c+0.5f+p.dx*p.t, py=worldY(p.r+0.5f+p.dy*p.t);
+  auto clampAxis=[](float center, float view, float extent){
+    return view>=extent ? (extent-view)*0.5f : std::clamp(center-view*0.5f, 0.0f, extent-view);
+  };
+  camX0=clampAxis(px, viewW, (float)m.cols());
+  camY0=clampAxis(py, viewH-HUD_H, (float)m.rows());
+}
+
+static void display(){
+  frameNo++;
+  followPacman();
+  const ChunkedMaze& m=sim.maze();
+  glClearColor(BG_COL.r,BG_COL.g,BG_COL.b,1.0f); glClear(GL_COLOR_BUFFER_BIT);
+  glMatrixMode(GL_PROJECTION); glLoadIdentity(); gluOrtho2D(camX0, camX0+viewW, camY0, camY0+viewH); glMatrixMode(GL_MODELVIEW);
+
+  // Only the chunks overlapping the viewport
+  int c0=std::max(0,(int)std::floor(camX0)/CHUNK), c1=std::min(m.chunkCols()-1,(int)std::floor(camX0+viewW)/CHUNK);
+  int r0=std::max(0,(int)std::floor(m.rows()-(camY0+viewH))/CHUNK), r1=std::min(m.chunkRows()-1,(int)std::floor(m.rows()-camY0)/CHUNK);
+  chunksDrawn=0;
+  glEnable(GL_POINT_SMOOTH); glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glPointSize(0.16f*pxPerUnit);
+  for(int cr=r0; cr<=r1; cr++) for(int cc=c0; cc<=c1; cc++){
+    ChunkMesh& s=meshFor(cr,cc); chunksDrawn++;
+    glColor3f(WALL_COL.r,WALL_COL.g,WALL_COL.b); glbufDraw(s.walls, GL_TRIANGLES, 0, s.walls.count);
+    glColor3f(DOT_COL.r,DOT_COL.g,DOT_COL.b);    glbufDraw(s.dots, GL_POINTS, 0, s.dots.count);
+  }
+  glDisable(GL_BLEND); glDisable(GL_POINT_SMOOTH);
+
+  glbufBind(spriteBuf);
+  RGBc gc[4]={BLINKY_COL,PINKY_COL,INKY_COL,CLYDE_COL};
+  for(int cr=r0; cr<=r1; cr++) for(int cc=c0; cc<=c1; cc++)
+    for(uint32_t i : sim.ghostsIn(cr,cc)){
+      const BigActor& g=sim.ghost(i);
+      drawSprite(sprites.ghost, g.c+0.5f+g.dx*g.t, worldY(g.r+0.5f+g.dy*g.t), 0.0f, &gc[i&3]);
+    }
+  const BigActor& p=sim.pacman();
+  float angle = (p.dx||p.dy) ? std::atan2((float)-p.dy, (float)p.dx)*180.0f/3.14159265f : 0.0f;
+  drawSprite(sprites.pac, p.c+0.5f+p.dx*p.t, worldY(p.r+0.5f+p.dy*p.t), angle, nullptr);
+  glbufUnbind();
+
+  // HUD band in window units: one row of 5x7 text
+  glMatrixMode(GL_PROJECTION); glLoadIdentity(); gluOrtho2D(0, viewW, 0, viewH); glMatrixMode(GL_MODELVIEW);
+  glColor3f(0,0,0); glRectf(0, viewH-HUD_H, viewW, viewH);
+  char buf[160];
+  std::snprintf(buf, sizeof(buf), "%dX%d  SCORE:%lld  CATCHES:%lld  AWAKE:%d/%zu  CHUNKS:%d/%d%s",
+                m.rows(), m.cols(), sim.score, sim.catches, sim.activeGhosts, sim.ghostCount(),
+                chunksDrawn, m.chunkRows()*m.chunkCols(), sim.autopilot ? "  AI" : "");
+  textSet(hudLine, buf);
+  textDraw(hudLine, 0.4f, viewH-HUD_H+0.35f, 0.5f/FONT_H, HUD_COL.r,HUD_COL.g,HUD_COL.b);
+  glutSwapBuffers();
+}
+
+// Fixed SIM_DT steps against the wall clock, at most a quarter second behind
+static void advanceSim(){
+  auto now=Clock::now();
+  acc += std::min(0.25f, std::chrono::duration<float>(now-lastTick).count()); lastTick=now;
+  while(acc>=SIM_DT){ sim.step(SIM_DT); acc-=SIM_DT; }
+}
+static void idle(){ advanceSim(); glutPostRedisplay(); }
+static void timer(int){ advanceSim(); glutPostRedisplay(); glutTimerFunc(16, timer, 0); }
+
+static void reshape(int w, int h){
+  pxPerUnit = std::min(w,h)/VIEW_CELLS; viewW = w/pxPerUnit; viewH = h/pxPerUnit;
+  glViewport(0,0,w,h);
+  if(sprites.pxPerUnit!=pxPerUnit){ buildSpriteSet(sprites, pxPerUnit); glbufUpload(spriteBuf, sprites.xy.data(), (int)sprites.xy.size()/2); }
+}
+
+static void special(int key, int, int){
+  if(key==GLUT_KEY_UP)    sim.steer(0,-1);
+  if(key==GLUT_KEY_DOWN)  sim.steer(0, 1);
+  if(key==GLUT_KEY_LEFT)  sim.steer(-1,0);
+  if(key==GLUT_KEY_RIGHT) sim.steer( 1,0);
+}
+static void keyboard(unsigned char k, int, int){
+  if(k==27) std::exit(0);
+  if(k=='a'||k=='A') sim.autopilot=!sim.autopilot;
+}
+
+void runBigMaze(int rows, int cols, unsigned long long seed, bool wantVsync){
+  auto t0=Clock::now();
+  sim.reset(rows, cols, seed);
+  std::printf("maze %dx%d (%d chunks, %.1f MiB) generated in %.2fs\n", sim.maze().rows(), sim.maze().cols(),
+              sim.maze().chunkRows()*sim.maze().chunkCols(), sim.maze().bytes()/1048576.0, std::chrono::duration<double>(Clock::now()-t0).count());
+  glbufInit(); glyphAtlasInit();
+  glutDisplayFunc(display); glutReshapeFunc(reshape);
+  glutSpecialFunc(special); glutKeyboardFunc(keyboard);
+  lastTick=Clock::now();
+  if(wantVsync && glSetSwapInterval(1)) glutIdleFunc(idle);
+  else glutTimerFunc(16, timer, 0);
+  glutMainLoop();
 }
 
 
@@ -334,53 +1830,88 @@ void onPassiveMotion(int x,int y){ float wy = windowToWorldY(y);
 // File: src/main.cpp
 // =====================================
 #include <GL/glut.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include "state.hpp"
 #include "render.hpp"
 #include "input.hpp"
+#include "simthread.hpp"
+#include "redraw.hpp"
+#include "bigview.hpp"
 
 // Core headers from your part
 #include "../your-part/include/config.hpp"
 #include "../your-part/include/types.hpp"
+#include "../your-part/include/world.hpp"
 #include "../your-part/include/maze.hpp"
 #include "../your-part/include/logic.hpp"
 #include "../your-part/include/powerups.hpp"
+#include "../your-part/include/util.hpp"
+#include "../your-part/include/profile.hpp"
 
 using namespace pac;
 
 // Single definitions (declared extern in headers)
 GameState gState = GameState::MENU;
 int hoverPlay=0, hoverExit=0, hoverPG_PlayAgain=0, hoverPG_Quit=0, hoverQC_PlayAgain=0, hoverQC_Quit=0;
-Runtime RT{};
+bool showProfiler=false;
+
+// Gameplay runs on the simulation thread (simthread.cpp); here we only follow
+// its snapshots to leave the game once the game-over hold is done. Older
+// snapshots from before the last "Play" are ignored.
+static void followSim(){
+  const SimFrame& f = simLatest();
+  if(gState==GameState::PLAYING && f.games==simGamesPosted() && f.world.rt.postMenuShown) gState = GameState::POSTGAME_MENU;
+}
 
-static void displayRouter(){ renderDisplay(); }
+static void displayRouter(){ followSim(); renderDisplay(); pac::profileFrameMark(); redrawFrameDone(); }
 static void reshapeCB(int w,int h){ reshapeView(w,h); }
 
-// 60 FPS-ish timer
-static void timerCB(int){
-  using Clock = std::chrono::steady_clock;
-  // If not in gameplay, we still need to handle the 2s hold after game over
-  if(gState==GameState::PLAYING){
-    if(RT.deathActive){ /* step handles death timing */ pac::step(RT); }
-    else if(!RT.paused){ pac::step(RT); }
-    // Show big overlay inside renderGame();
-    if(RT.gameOver && !RT.postMenuShown){
-      float tHold = std::chrono::duration<float>(Clock::now() - RT.tGameOverAt).count();
-      if(tHold >= 2.0f){ RT.postMenuShown = true; gState = GameState::POSTGAME_MENU; }
-    }
-  }
-  glutPostRedisplay(); glutTimerFunc(16, timerCB, 0);
-}
-
 int main(int argc,char** argv){
-  std::srand((unsigned)time(NULL));
-  copyMazeFromTemplate();
-  // Let startNewGame() set counters when user clicks Play; still prep powerups arrays
-  resetSupers(RT); resetHeart(RT);
+  glutInit(&argc,argv);   // strips GLUT's own options first
+
+  // pacman [--seed N] [--record FILE] [--fps N] [--no-vsync] [--big RxC]
+  //        [--levels PACK [--level N]]: the seed is printed so any session can
+  // be replayed; --record appends this session's inputs to FILE for
+  // pac_replay; --fps paces redraws when vsync is off; --big opens the soak
+  // view on a generated RxC maze instead; --levels plays level N of a pack
+  unsigned long long seed = (unsigned long long)time(NULL); const char* recPath = nullptr;
+  double fps = 60.0; bool wantVsync = true; int bigRows = 0, bigCols = 0;
+  const char* packPath = nullptr; int packLevel = 0;
+  for(int i=1;i<argc;i++){
+    if(std::strcmp(argv[i],"--no-vsync")==0) wantVsync = false;
+    if(i+1>=argc) continue;
+    if(std::strcmp(argv[i],"--seed")==0) seed = std::strtoull(argv[i+1],nullptr,10);
+    if(std::strcmp(argv[i],"--record")==0) recPath = argv[i+1];
+    if(std::strcmp(argv[i],"--fps")==0) fps = std::atof(argv[i+1]);
+    if(std::strcmp(argv[i],"--levels")==0) packPath = argv[i+1];
+    if(std::strcmp(argv[i],"--level")==0) packLevel = std::atoi(argv[i+1]);
+    if(std::strcmp(argv[i],"--big")==0 && std::sscanf(argv[i+1], "%dx%d", &bigRows, &bigCols)==1) bigCols = bigRows;
+  }
+  std::printf("seed %llu\n", seed);
+  if(bigRows > 0){
+    glutInitDisplayMode(GLUT_DOUBLE|GLUT_RGB);
+    glutInitWindowSize(960,720);
+    glutCreateWindow("PAC-MAN — soak view");
+    runBigMaze(bigRows, bigCols, seed, wantVsync);
+  }
+  int level = 0;
+  if(packPath){
+    int first = pac::loadLevelPack(packPath);
+    if(first<0){ std::fprintf(stderr, "%s is not a level pack\n", packPath); return 1; }
+    if(packLevel<0 || first+packLevel>=pac::levelCount()){ std::fprintf(stderr, "%s has no level %d\n", packPath, packLevel); return 1; }
+    level = first+packLevel;
+  }
+  // startNewGame() runs when the user clicks Play; until then the thread idles
+  simStart(seed, recPath, level);
+  std::atexit(simStop);   // GLUT leaves through exit()
 
-  glutInit(&argc,argv);
   glutInitDisplayMode(GLUT_DOUBLE|GLUT_RGB);
   glutInitWindowSize(760,820);
   glutCreateWindow("PAC-MAN — GLUT (Render/Input Shell)");
+  initRenderer();
   glutDisplayFunc(displayRouter);
   glutReshapeFunc(reshapeCB);
   glutSpecialFunc(onSpecialKey);
@@ -388,8 +1919,7 @@ int main(int argc,char** argv){
   glutMouseFunc(onMouseClick);
   glutPassiveMotionFunc(onPassiveMotion);
 
-  RT.tStart = RT.tLast = std::chrono::steady_clock::now();
-  glutTimerFunc(16, timerCB, 0);
+  redrawStart(wantVsync, fps);
   glutMainLoop();
   return 0;
 }
@@ -401,27 +1931,107 @@ int main(int argc,char** argv){
 cmake_minimum_required(VERSION 3.15)
 project(pacman_glut_shell CXX)
 set(CMAKE_CXX_STANDARD 17)
+# Benchmarks and batch runs are meaningless unoptimized; default to Release
+if(NOT CMAKE_BUILD_TYPE AND NOT CMAKE_CONFIGURATION_TYPES)
+  set(CMAKE_BUILD_TYPE Release)
+endif()
 
-find_package(OpenGL REQUIRED)
-find_package(GLUT REQUIRED)
-
-include_directories(${OPENGL_INCLUDE_DIR} ${GLUT_INCLUDE_DIR}
-  ${CMAKE_CURRENT_LIST_DIR}/include
-  ${CMAKE_CURRENT_LIST_DIR}/../your-part/include)
+# Headless-only builds skip GL/GLUT entirely (CI and batch boxes without a display)
+option(PAC_HEADLESS_ONLY "Build only the window-less simulation targets" OFF)
 
-add_executable(pacman
-  src/main.cpp
-  src/render.cpp
-  src/input.cpp
-  # Core sources from your-part (adjust the relative path if needed)
+# Core sources from your-part (adjust the relative path if needed)
+add_library(pac_core STATIC
   ../your-part/src/config.cpp
   ../your-part/src/maze.cpp
+  ../your-part/src/paths.cpp
+  ../your-part/src/level.cpp
+  ../your-part/src/mapfile.cpp
   ../your-part/src/powerups.cpp
   ../your-part/src/logic.cpp
   ../your-part/src/util.cpp
+  ../your-part/src/batch.cpp
+  ../your-part/src/events.cpp
+  ../your-part/src/autopilot.cpp
+  ../your-part/src/profile.cpp
+  ../your-part/src/replay.cpp
+  ../your-part/src/rewind.cpp
+  ../your-part/src/vecenv.cpp
+  ../your-part/src/mcts.cpp
+  ../your-part/src/bigmaze.cpp
 )
-
-target_link_libraries(pacman ${OPENGL_LIBRARIES} ${GLUT_LIBRARY})
+target_include_directories(pac_core PUBLIC ${CMAKE_CURRENT_LIST_DIR}/../your-part/include)
+find_package(Threads REQUIRED)
+target_link_libraries(pac_core PUBLIC Threads::Threads)
+
+# Whole games at fixed timestep, as fast as the CPU allows
+add_executable(pac_headless ../your-part/src/headless.cpp)
+target_link_libraries(pac_headless pac_core)
+
+# Re-runs recorded input logs (pacman --record) at full speed
+add_executable(pac_replay ../your-part/src/replayer.cpp)
+target_link_libraries(pac_replay pac_core)
+
+# Batched RL environment driven with random actions (throughput + checksum)
+add_executable(pac_vecenv ../your-part/src/vecenv_run.cpp)
+target_link_libraries(pac_vecenv pac_core)
+
+# Runtime-sized chunked mazes on the simulated clock (soak/stress)
+add_executable(pac_soak ../your-part/src/soak.cpp)
+target_link_libraries(pac_soak pac_core)
+
+# Writes and inspects level packs (.pacl)
+add_executable(pac_levels ../your-part/src/levelpack.cpp)
+target_link_libraries(pac_levels pac_core)
+
+# ctest: self-checks of the tools above, all headless
+enable_testing()
+add_test(NAME events_match_fixed_random COMMAND pac_headless --compare 300 7)
+add_test(NAME events_match_fixed_greedy COMMAND pac_headless --compare --greedy 100 1)
+add_test(NAME coarse_step_matches_ticks COMMAND pac_vecenv --compare --ticks 8 64 500 1)
+add_test(NAME level_pack_refuses_corrupt COMMAND pac_levels check ${CMAKE_CURRENT_BINARY_DIR}/check.pacl)
+
+# Software rasterizer (offscreen frames without GL or a display)
+add_library(pac_soft STATIC
+  src/softraster.cpp
+  src/sprites.cpp
+  src/font5x7.cpp
+)
+target_include_directories(pac_soft PUBLIC ${CMAKE_CURRENT_LIST_DIR}/include)
+target_link_libraries(pac_soft PUBLIC pac_core)
+
+# Thumbnails and render throughput for one game
+add_executable(pac_thumbs src/thumbs.cpp)
+target_link_libraries(pac_thumbs pac_soft)
+
+# Microbenchmarks; pac_bench --csv base.csv once, then pac_bench --baseline base.csv
+add_executable(pac_bench src/bench.cpp)
+target_link_libraries(pac_bench pac_soft)
+# bench/baseline.csv comes from one dev machine: fail only on 2x slowdowns
+add_test(NAME bench_vs_baseline COMMAND pac_bench --baseline ${CMAKE_CURRENT_SOURCE_DIR}/bench/baseline.csv --threshold 100)
+
+if(NOT PAC_HEADLESS_ONLY)
+  find_package(OpenGL REQUIRED)
+  find_package(GLUT REQUIRED)
+
+  include_directories(${OPENGL_INCLUDE_DIR} ${GLUT_INCLUDE_DIR}
+    ${CMAKE_CURRENT_LIST_DIR}/include
+    ${CMAKE_CURRENT_LIST_DIR}/../your-part/include)
+
+  add_executable(pacman
+    src/main.cpp
+    src/render.cpp
+    src/input.cpp
+    src/glbuf.cpp
+    src/sprites.cpp
+    src/simthread.cpp
+    src/redraw.cpp
+    src/font5x7.cpp
+    src/glyphatlas.cpp
+    src/bigview.cpp
+  )
+
+  target_link_libraries(pacman pac_core ${OPENGL_LIBRARIES} ${GLUT_LIBRARY})
+endif()
 
 
 // =====================================
@@ -453,10 +2063,55 @@ make -j
 
 > If your folder structure differs, update the paths in `CMakeLists.txt` that point to `../your-part/`.
 
+Gameplay runs on its own thread at a steady 120 ticks/s (`simthread.cpp`). The GLUT thread only draws the newest snapshot it publishes and queues key presses back to it, so a slow frame never delays a tick. Actors are drawn interpolated between the last two ticks. Redraws follow vsync when the driver offers swap control; otherwise they follow a drift-free timer at `--fps N` (default 60). `--no-vsync` forces the timer. Nothing is redrawn while nothing on screen moves (menus, pause, the win screen), so the app idles between input events.
+
+Each game draws from its own PCG32 stream. `./pacman` prints its seed on start; `./pacman --seed N` plays the same session again.
+
+## Headless simulation
+`pac_headless [games] [seed] [threads] [pack.pacl]` plays whole games on the simulated clock (`pac::step(w, SIM_DT)`) with a random-walk autopilot and no window, spread over a `pac::BatchRunner` thread pool. Same seed, same results, whatever the thread count. With a level pack, the games cycle through its levels.
+`--events` advances each world straight to its next event instead (`pac::stepToNextEvent`, `events.hpp`). Events are the ticks on which something can happen: Pac-Man or a ghost in a cell-center window where it may turn, Pac-Man entering a pellet cell or stopping at a wall, a contact, or a timer. The ticks in between go through `pac::coast()`, which moves everyone with the same per-tick code as `step()`, and the event tick is a plain `step()`. So the games are bit for bit the fixed-tick games. That takes about 4.7x fewer iterations than fixed ticks, but only about 1.1x less time, because each event pays for a full `step()` plus the look-ahead.
+`--greedy` plays a pellet-greedy autopilot instead of the random walk. `--compare` plays every game both ways and prints per-game scores, end times and position drift, plus a count of identical games. It exits 1 unless every game is identical, and `ctest` runs it for both policies. `pac_headless --compare 1000 7` reports 1000 of 1000 identical.
+Configure with `-DPAC_HEADLESS_ONLY=ON` on machines without OpenGL/GLUT.
+
+## Large mazes
+The stock board is a compile-time 19x21. For stress and soak runs, `pac::ChunkedMaze` (`bigmaze.hpp`) generates runtime-sized mazes up to 16384 cells a side. They are stored as 64x64-cell chunks, one 64-bit word per chunk row. `pac::BigSim` moves Pac-Man and 4 ghosts per chunk, but only the ghosts within one chunk of Pac-Man are awake, so a tick costs the same at any maze size.
+- `pac_soak [rows] [cols] [seconds] [seed]` runs it headless and prints ticks/s.
+- `./pacman --big 4096x4096` opens the soak view: a camera that follows Pac-Man and meshes and draws only the chunks in view. Arrows steer, A toggles the autopilot.
+
+## Level packs
+A `.pacl` pack (`level.hpp`) stores any number of 19x21 levels. Each level record holds the bit planes plus everything derived from them: the pellet count, per-cell Pac-Man neighbour masks, the cells power-ups may spawn on, the all-pairs path table the ghosts chase with, and a junction graph. The graph's nodes are the cells where a ghost has a real choice, and its edges are corridor runs weighted by length. Ghosts never reverse, so on corridor cells the move is forced and the chase AI only runs at junctions. Records are 8-byte aligned and used in place, so opening a pack is one `mmap` plus a check of each level: index entries must be in range, and the direction masks, junction ids, pellet count and connectivity flag must match the bit planes. Corrupt files are refused. Nothing is parsed or rebuilt, and the built-in maze is just level 0.
+- `pac_levels build levels.pacl [count] [seed]` writes the stock maze plus `count-1` random variants with every pellet reachable.
+- `pac_levels info levels.pacl` times the open against rebuilding the tables and lists the levels.
+- `pac_levels check scratch.pacl` writes packs with one corrupted field each (a flipped mask byte, an id out of range, a wrong pellet count) and fails unless all are refused. `ctest` runs it.
+- `./pacman --levels levels.pacl --level 3` plays one level. Recorded sessions store their level index, so replay them with the same `--levels` packs, given in the same order.
+
+## RL environment
+`pac::VecEnv` (`vecenv.hpp`) runs N worlds as one vectorised environment. `reset(seed, obs)` and `step(actions, obs, reward, done)` write observations into caller-owned arrays: 6 float planes of ROWS x COLS per env (walls, pellets, Pac-Man, ghosts, supers, heart). They also write the score gained and episode-end flags. Finished envs restart on their own. Steps run on a `BatchRunner` across all cores, allocate nothing, and give the same results for any thread count. `pac_vecenv [envs] [steps] [seed] [threads]` drives it with random actions and prints env-steps/s.
+`step(w, dt)` with dt a whole number of ticks plays exactly that many `SIM_DT` ticks. It runs them through the event stepper, so every contact, pellet, turn and spawn lands on the tick it would in fixed-tick play, in the same order. `VecEnv(..., swept=true)` (`pac_vecenv --swept`) advances each action as one such step, in fewer iterations and with the same episodes. `pac_vecenv --compare --ticks 8` plays both ways on the same actions and exits 1 unless reward, done flag and state agree for every env after every action. `ctest` runs it.
+
+## Recording and replay
+`./pacman --record session.pacr` appends the session's seed and every game input, stamped with its simulation tick, to `session.pacr`. The game runs on fixed `SIM_DT` steps, so the log reproduces it exactly. The format is a 16-byte header plus about 2 bytes per input, and several sessions can share one file.
+`pac_replay [--mmap] [--threads N] [--quiet] [--levels PACK]... log...` re-runs every session in the given files at full speed and prints the final score and a world digest per session. Compare the output of two builds to spot behaviour changes. `--mmap` maps large archives instead of reading them.
+
+## Offscreen rendering
+`pac_thumbs [seed] [w] [h] [every] [outdir]` draws one autopilot game with the software rasterizer in `softraster.cpp` (same layout and sprite meshes as the GL renderer, 5x7 bitmap font for text) and prints frames per second. Pass `outdir` to save every `every`-th frame as a PPM thumbnail. Needs no GL or display, so it also builds with `PAC_HEADLESS_ONLY`.
+
+## Benchmarks
+`pac_bench` times `step`, `updateGhosts`, `chooseGhostDirWithChase`, `countDots`, `copyMazeFromTemplate`, the super spawner on a crowded board, and each render pass on the software rasterizer, all from one seeded mid-game world. It reports median/min/p90 ns per op. The render cases are named `softraster/*` because they time `softraster.cpp`, not the GL passes (`renderMaze()`, `renderHUD()`, ...). Those draw through GLUT and need a window, so the software passes stand in for them, and the bench output says so.
+```bash
+./pac_bench --csv base.csv                    # save a baseline on this machine
+./pac_bench --baseline base.csv --json now.json  # compare; exit code 1 if a median is >10% slower
+```
+`--filter core` runs a subset; `--threshold 5` tightens the check. Builds default to Release. `bench/baseline.csv` is a committed baseline, and `ctest` compares against it with `--threshold 100`. The loose threshold is there because the file comes from one machine, so the test only catches 2x slowdowns. On fixed CI hardware, regenerate it with `--csv` there and tighten the threshold.
+
 ## Controls
 - **Arrow Keys**: Move
 - **P**: Pause/Resume
 - **R**: Restart (while playing)
+- **Z**: Rewind half a second (holds the last 10 s of play)
+- **A**: Toggle the AI player: root-parallel Monte Carlo tree search over cloned worlds, about 6 ms per turn on all cores. Its moves are recorded like key presses
+- **F3**: Frame profiler overlay (p50/p99 per phase, frame-time histogram)
+- **F4**: Start a trace capture; press again to write `pac_trace.json` (open in `chrome://tracing` or Perfetto)
 - **ESC**: Quit
 
 ## Ownership
@@ -2,22 +2,54 @@
 # ├─ include/
 # │  ├─ config.hpp
 # │  ├─ types.hpp
+# │  ├─ world.hpp
 # │  ├─ maze.hpp
+# │  ├─ paths.hpp
+# │  ├─ level.hpp
+# │  ├─ bitboard.hpp
+# │  ├─ rng.hpp
 # │  ├─ powerups.hpp
 # │  ├─ logic.hpp
-# │  └─ util.hpp
+# │  ├─ util.hpp
+# │  ├─ batch.hpp
+# │  ├─ events.hpp
+# │  ├─ autopilot.hpp
+# │  ├─ profile.hpp
+# │  ├─ replay.hpp
+# │  ├─ mapfile.hpp
+# │  ├─ rewind.hpp
+# │  ├─ handoff.hpp
+# │  ├─ vecenv.hpp
+# │  ├─ mcts.hpp
+# │  └─ bigmaze.hpp
 # └─ src/
 #    ├─ config.cpp
 #    ├─ maze.cpp
+#    ├─ paths.cpp
+#    ├─ level.cpp
 #    ├─ powerups.cpp
 #    ├─ logic.cpp
-#    └─ util.cpp
+#    ├─ util.cpp
+#    ├─ batch.cpp
+#    ├─ events.cpp
+#    ├─ autopilot.cpp
+#    ├─ profile.cpp
+#    ├─ replay.cpp
+#    ├─ mapfile.cpp
+#    ├─ rewind.cpp
+#    ├─ vecenv.cpp
+#    ├─ mcts.cpp
+#    ├─ bigmaze.cpp
+#    ├─ headless.cpp
+#    ├─ replayer.cpp
+#    ├─ vecenv_run.cpp
+#    ├─ soak.cpp
+#    └─ levelpack.cpp
 
 // =============================
 // File: include/types.hpp
 // =============================
 #pragma once
-#include <chrono>
 
 namespace pac {
 
@@ -28,14 +60,15 @@ struct Actor { float x, y, vx, vy, radius; };
 // Maze cells
 enum Cell { WALL=1, DOTCELL=0, EMPTY=-1, GATE=2 };
 
-// Runtime bag (timers & counters)
+// Runtime bag (timers & counters). All times are simulated seconds since
+// startNewGame(); the core never reads a wall clock, callers advance it via step().
 struct Runtime {
   int pelletsTotal=0, pelletsEaten=0, score=0, lives=3;
   bool paused=false, gameOver=false, winGame=false;
   bool deathActive=false, postMenuShown=false;
   float pacAngleDeg=0.0f;
   float lastSuperSpawnAt=0.0f, lastHeartSpawnAt=0.0f;
-  std::chrono::steady_clock::time_point tStart, tLast, tDeathStart, tGameOverAt;
+  float simTime=0.0f, tDeathStart=0.0f, tGameOverAt=0.0f;
 };
 
 // Power ups
@@ -45,6 +78,44 @@ struct Heart     { bool active; int r,c; };
 } // namespace pac
 
 
+// =============================
+// File: include/world.hpp
+// =============================
+#pragma once
+#include <type_traits>
+#include "types.hpp"
+#include "config.hpp"
+#include "bitboard.hpp"
+#include "rng.hpp"
+
+namespace pac {
+
+// One self-contained game session. Plain value type: no globals, no pointers,
+// so any number of worlds can live side by side and be stepped on any thread.
+// Walls and the gate never change, so only the pellet plane is per world;
+// the rest of the maze is shared through the level registry (level.hpp).
+// Copying a World (plain assignment, a single memcpy) is a full snapshot.
+struct World {
+  Runtime   rt;
+  BitBoard  pellets;    // DOTCELLs not eaten yet
+  uint16_t  level = 0;  // registry index of the maze played; set before startNewGame()
+  Actor     pacman    {9.5f,15.5f,0,0,0.33f};
+  Actor     ghosts[4] {
+    {9.5f,10.5f,0,0,0.33f},
+    {7.5f,10.5f,0,0,0.33f},
+    {11.5f,10.5f,0,0,0.33f},
+    {9.5f, 9.5f,0,0,0.33f}
+  };
+  int       gDx[4] = {0}, gDy[4] = {0};
+  SuperFood supers[MAX_SUPERS] = {};
+  Heart     heart {false,0,0};
+  Pcg32     rng;       // per-world random stream, see seedRng()/randBelow()
+};
+static_assert(std::is_trivially_copyable<World>::value, "World must stay memcpy-able: snapshots, rewind and batch runs copy it raw");
+
+} // namespace pac
+
+
 // =============================
 // File: include/config.hpp
 // =============================
@@ -63,6 +134,12 @@ inline constexpr float GHOST_SPEED0 = 3.0f;
 inline constexpr float GHOST_STEP   = 0.35f;
 inline constexpr int   STEP_EVERY_S = 15;
 
+// Power-up slots
+inline constexpr int MAX_SUPERS = 3;
+
+// Fixed simulation timestep for headless runs (seconds)
+inline constexpr float SIM_DT = 1.0f/120.0f;
+
 // Colors
 extern RGBc BG_COL;
 extern RGBc WALL_COL;
@@ -86,52 +163,301 @@ void initConfig();
 #pragma once
 #include "types.hpp"
 #include "config.hpp"
+#include "world.hpp"
+#include "level.hpp"
 
 namespace pac {
 
-extern int MAZE[ROWS][COLS];
+// The built-in maze, level 0 of the registry
+extern const int MAZE_TEMPLATE[ROWS][COLS];
+
+// The level w plays (w.level in the registry)
+inline const Level& levelOf(const World& w){ return level(w.level); }
 
-// Copy template into MAZE
-void copyMazeFromTemplate();
-// Count DOTCELL in current MAZE
-int  countDots();
+inline bool isWallCell(const World& w,int r,int c){ return levelOf(w).planes().walls.test(r,c); }
+inline bool isGateCell(const World& w,int r,int c){ return levelOf(w).planes().gates.test(r,c); }
+
+// Reset w.pellets from its level
+void copyMazeFromTemplate(World& w);
+// Pellets left in w (popcount)
+int  countDots(const World& w);
 
 } // namespace pac
 
 
 // =============================
-// File: include/powerups.hpp
+// File: include/paths.hpp
 // =============================
 #pragma once
-#include "types.hpp"
+#include <cstdint>
 #include "config.hpp"
 
 namespace pac {
 
-inline constexpr int MAX_SUPERS = 3;
+// Move directions shared by the ghost AI: right, left, up, down (world dx/dy)
+inline constexpr int DIR_DX[4] = {1,-1,0,0};
+inline constexpr int DIR_DY[4] = {0,0,1,-1};
+inline constexpr uint8_t DIR_NONE = 4;
+// Index of a unit move in DIR_DX/DIR_DY, DIR_NONE for (0,0); k^1 reverses k
+inline int dirIndex(int dx,int dy){ return dx>0 ? 0 : dx<0 ? 1 : dy>0 ? 2 : dy<0 ? 3 : DIR_NONE; }
+inline constexpr uint16_t DIST_FAR = 0xffff;
+
+// All-pairs shortest paths over ghost-walkable cells (anything but WALL).
+// Cells get dense ids; dist/next are nCells x nCells, row = from, column = to.
+// A read-only view: the arrays live in a level record (level.hpp), built in
+// memory or mapped straight from a level pack.
+struct PathTable {
+  int nCells = 0;
+  const int16_t*  index  = nullptr;  // r*COLS+c -> dense id, -1 for walls
+  const int16_t*  cellOf = nullptr;  // dense id -> r*COLS+c
+  const int16_t*  nbr    = nullptr;  // dense id*4+dir -> neighbour id, -1 when blocked
+  const uint16_t* dist   = nullptr;  // steps from a to b, DIST_FAR if unreachable
+  const uint8_t*  next   = nullptr;  // first direction from a toward b, DIR_NONE if a==b/unreachable
+
+  int idAt(int r,int c) const { return (r<0||r>=ROWS||c<0||c>=COLS) ? -1 : index[r*COLS+c]; }
+  int distBetween(int a,int b) const { return dist[(std::size_t)a*nCells+b]; }
+  int nextDir(int a,int b) const { return next[(std::size_t)a*nCells+b]; }
+};
+
+// Walkable cells of a template, i.e. the nCells its table will have
+int pathCellCount(const int maze[ROWS][COLS]);
+// One BFS per walkable cell: O(cells^2), well under a millisecond for the stock
+// maze. Fills caller-owned arrays sized BOARD_CELLS, n, 4n, n*n and n*n.
+void buildPathTable(const int maze[ROWS][COLS], int16_t* index, int16_t* cellOf, int16_t* nbr, uint16_t* dist, uint8_t* next);
+
+// Distance-to-target field over dense cell ids: the target's row of the
+// all-pairs table (the maze graph is undirected), so it is a view, built on
+// demand and never stored in a World
+struct FlowField {
+  int             root = -1;       // dense id of the target cell, -1 = none
+  const uint16_t* dist = nullptr;  // steps to root, DIST_FAR if unreachable
+};
+inline FlowField flowField(const PathTable& pt, int root){
+  return root<0 ? FlowField{} : FlowField{root, &pt.dist[(std::size_t)root*pt.nCells]};
+}
+
+} // namespace pac
+
+
+// =============================
+// File: include/level.hpp
+// =============================
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "config.hpp"
+#include "paths.hpp"
+#include "bitboard.hpp"
+
+namespace pac {
+
+// Static bit planes of a level
+struct MazePlanes {
+  BitBoard walls, gates;
+  BitBoard pacBlocked;   // walls | gates
+  BitBoard pellets0;     // DOTCELLs at the start of a game
+};
+
+// Per-cell arrays are padded to a multiple of 8 so every section stays aligned
+inline constexpr int LEVEL_CELLS = (BOARD_CELLS+7) & ~7;
+
+// One corridor of the junction graph: leaving a cell in some direction, the
+// ghost path runs len cells through forced moves and arrives at junction
+// cell end moving in direction arrive. end is -1 if it never reaches one.
+struct CorridorRun { int16_t end; uint8_t len; uint8_t arrive; };
+
+// Fixed-size head of a level record: everything a World reads from its maze,
+// worked out when the level is built. Plain data, used in place.
+struct LevelHeader {
+  char       name[16];
+  MazePlanes planes;
+  int32_t    pelletCount;                // pellets0.count()
+  int32_t    nCells;                     // ghost-walkable cells, the path table size
+  int32_t    spawnCount;                 // open floor cells in spawnCells
+  uint32_t   bytes;                      // whole record: header + path table, 8-aligned
+  int32_t    junctionCount;              // cells where a ghost has a real choice
+  int32_t    ghostConnected;             // every ghost-walkable cell reaches every other
+  uint8_t    nbrMask[LEVEL_CELLS];       // r*COLS+c -> bit d set if Pac-Man can step DIR_DX/DY[d]
+  uint16_t   spawnCells[LEVEL_CELLS];    // r*COLS+c of every cell a power-up may appear on
+  int16_t    pathIndex[LEVEL_CELLS];     // PathTable::index
+  // Junction graph over ghost-walkable cells. Ghosts never reverse, so on a
+  // cell with exactly two ways out the move is forced; every other cell (forks,
+  // dead ends) is a junction. runs[cell*4+d] are the weighted edges.
+  uint8_t    ghostMask[LEVEL_CELLS];     // bit d set if a ghost can step DIR_DX/DY[d]
+  int16_t    junctionId[LEVEL_CELLS];    // dense junction id, -1 on corridor cells and walls
+  CorridorRun runs[LEVEL_CELLS*4];
+};
+static_assert(sizeof(LevelHeader)%8==0, "level sections must stay 8-aligned");
+
+// A level record (LevelHeader, then int16 cellOf[n], int16 nbr[4n],
+// uint16 dist[n*n], uint8 next[n*n], each 8-aligned) seen through pointers
+struct Level {
+  const LevelHeader* hdr = nullptr;
+  PathTable paths;
+  const MazePlanes& planes() const { return hdr->planes; }
+};
+
+// Serialises one level record from a cell template (WALL/GATE/DOTCELL/EMPTY)
+void buildLevel(const int maze[ROWS][COLS], const char* name, std::vector<uint8_t>& out);
+// Wraps a record in place (p must be 8-aligned); false if truncated, inconsistent
+// or holding an out-of-range index
+bool viewLevel(const uint8_t* p, std::size_t n, Level& out);
+
+// Level pack (.pacl), native little-endian, one file for any number of levels:
+//   header  "PACL" u8 version u8 ROWS u8 COLS u8 0, u32 count, u32 0     16 bytes
+//   u64 offset[count]   file offset of each level record, 8-aligned
+//   records             as built by buildLevel()
+// Loading is a map and one O(cells) check per level (indices in range, masks,
+// junction ids, pellet count and ghostConnected as the planes give them):
+// nothing parsed, no tables rebuilt.
+inline constexpr uint8_t LEVEL_PACK_VERSION = 2;   // 2: junction graph
+bool writeLevelPack(const char* path, const std::vector<std::vector<uint8_t>>& records);
+
+// Level registry. Level 0 is the built-in maze; packs append theirs. A World
+// names its level by index so it stays pointer-free. The table is read on
+// every wall test, so the lookup is inline: a bounds check and an index.
+extern const Level* LEVEL_TABLE;   // nullptr until first use, grown by loadLevelPack()
+extern int          LEVEL_TABLE_SIZE;
+const Level* initLevelTable();     // builds level 0 once; safe from static initializers
+inline int levelCount(){ if(!LEVEL_TABLE) initLevelTable(); return LEVEL_TABLE_SIZE; }
+// Out-of-range indices fall back to level 0
+inline const Level& level(int i){
+  const Level* t = LEVEL_TABLE ? LEVEL_TABLE : initLevelTable();
+  return t[(unsigned)i < (unsigned)LEVEL_TABLE_SIZE ? i : 0];
+}
+// Maps a pack for the rest of the run and appends its levels. Returns the index
+// of its first level, or -1. Not thread-safe: load before any world runs.
+int  loadLevelPack(const char* path, bool useMmap=true);
+
+} // namespace pac
+
+
+// =============================
+// File: include/bitboard.hpp
+// =============================
+#pragma once
+#include <cstdint>
+#include "config.hpp"
+
+namespace pac {
+
+inline constexpr int BOARD_CELLS = ROWS*COLS;
+inline constexpr int BOARD_WORDS = (BOARD_CELLS+63)/64;
+
+inline int popcount64(uint64_t x){
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(x);
+#else
+  int n=0; while(x){ x&=x-1; n++; } return n;
+#endif
+}
+
+// Index of the lowest set bit; x must not be 0
+inline int ctz64(uint64_t x){
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(x);
+#else
+  int n=0; while(!(x&1)){ x>>=1; n++; } return n;
+#endif
+}
+
+// One bit per maze cell, row-major (bit r*COLS+c), 7 words for the stock
+// maze. Whole-board ops are fixed-length word loops the compiler unrolls and
+// vectorises. Bits past BOARD_CELLS always stay zero.
+struct BitBoard {
+  uint64_t w[BOARD_WORDS] = {};
+
+  static constexpr int bit(int r,int c){ return r*COLS+c; }
+  constexpr bool test(int r,int c) const { int b=bit(r,c); return (w[b>>6]>>(b&63)) & 1u; }
+  constexpr void set(int r,int c)   { int b=bit(r,c); w[b>>6] |=  (uint64_t)1<<(b&63); }
+  constexpr void clear(int r,int c) { int b=bit(r,c); w[b>>6] &= ~((uint64_t)1<<(b&63)); }
+
+  int  count() const { int n=0; for(int i=0;i<BOARD_WORDS;i++) n+=popcount64(w[i]); return n; }
+  bool any()   const { uint64_t a=0; for(int i=0;i<BOARD_WORDS;i++) a|=w[i]; return a!=0; }
+
+  constexpr BitBoard& operator|=(const BitBoard& o){ for(int i=0;i<BOARD_WORDS;i++) w[i]|=o.w[i]; return *this; }
+  constexpr BitBoard& operator&=(const BitBoard& o){ for(int i=0;i<BOARD_WORDS;i++) w[i]&=o.w[i]; return *this; }
+  constexpr BitBoard& andNot(const BitBoard& o)    { for(int i=0;i<BOARD_WORDS;i++) w[i]&=~o.w[i]; return *this; }
+  bool operator==(const BitBoard& o) const { uint64_t d=0; for(int i=0;i<BOARD_WORDS;i++) d|=w[i]^o.w[i]; return d==0; }
+  bool operator!=(const BitBoard& o) const { return !(*this==o); }
+};
+
+} // namespace pac
+
+
+// =============================
+// File: include/rng.hpp
+// =============================
+#pragma once
+#include <cstdint>
+
+namespace pac {
+
+// PCG32 (XSH-RR, 64-bit state): 16 bytes, a multiply and a rotate per draw.
+// Plain data, so it copies with the World and never touches shared state.
+// seed picks the start point, stream one of 2^63 independent sequences.
+struct Pcg32 {
+  uint64_t state = 0x853c49e6748fea9bULL;
+  uint64_t inc   = 0xda3e39cb94b95bdbULL;   // always odd
+};
+
+inline uint32_t pcgNext(Pcg32& g){
+  uint64_t old = g.state;
+  g.state = old*6364136223846793005ULL + g.inc;
+  uint32_t xs = (uint32_t)(((old>>18)^old)>>27), rot = (uint32_t)(old>>59);
+  return (xs>>rot) | (xs<<((0u-rot)&31));
+}
+
+inline void pcgSeed(Pcg32& g, uint64_t seed, uint64_t stream=0){
+  g.state = 0; g.inc = (stream<<1)|1u;
+  pcgNext(g); g.state += seed; pcgNext(g);
+}
+
+// Uniform in [0,n) without modulo bias (Lemire's multiply-shift with rejection)
+inline uint32_t pcgBelow(Pcg32& g, uint32_t n){
+  uint64_t m = (uint64_t)pcgNext(g)*n;
+  if((uint32_t)m < n){
+    uint32_t t = (0u-n) % n;
+    while((uint32_t)m < t) m = (uint64_t)pcgNext(g)*n;
+  }
+  return (uint32_t)(m>>32);
+}
+
+} // namespace pac
 
-// Global state (owned by core)
-extern SuperFood supers[MAX_SUPERS];
-extern Heart     heart;
+
+// =============================
+// File: include/powerups.hpp
+// =============================
+#pragma once
+#include "types.hpp"
+#include "config.hpp"
+#include "world.hpp"
+
+namespace pac {
 
 // Spawning cadence
 inline constexpr float SUPER_SPAWN_INTERVAL = 10.0f; // seconds
 inline constexpr float HEART_SPAWN_INTERVAL = 10.0f; // seconds
 
 // Reset
-void resetSupers(Runtime& rt);
-void resetHeart (Runtime& rt);
+void resetSupers(World& w);
+void resetHeart (World& w);
 
 // Tick-time spawners (call from step)
-void maybeSpawnSupers(Runtime& rt, float elapsedSeconds);
-void maybeSpawnHeart (Runtime& rt, float elapsedSeconds);
+void maybeSpawnSupers(World& w, float elapsedSeconds);
+void maybeSpawnHeart (World& w, float elapsedSeconds);
 
-// Eat checks (call after pac update)
-void checkEatSuper(Runtime& rt, const Actor& pac);
-void checkEatHeart(Runtime& rt,       Actor& pac);
+// Eat checks (call after pac update). The swept forms test Pac-Man's whole
+// move from (fromX,fromY), so a long step can't carry him past a power-up.
+void checkEatSuper(World& w);
+void checkEatHeart(World& w);
+void checkEatSuper(World& w, float fromX, float fromY);
+void checkEatHeart(World& w, float fromX, float fromY);
 
 // Lightweight accessors for renderer (optional)
-int  activeSuperCount();
+int  activeSuperCount(const World& w);
 
 } // namespace pac
 
@@ -140,20 +466,671 @@ int  activeSuperCount();
 // File: include/util.hpp
 // =============================
 #pragma once
+#include <cstdint>
 #include "types.hpp"
 #include "config.hpp"
+#include "world.hpp"
 
 namespace pac {
 
 int   yToRow(float y);
 int   xToCol(float x);
-bool  blockedForPac(int r,int c);
-bool  blockedForGhostCell(int r,int c);
+bool  blockedForPac(const World& w,int r,int c);
+bool  blockedForGhostCell(const World& w,int r,int c);
 float clampf(float v,float lo,float hi);
 
 float cellCenterX(int c);
 float cellCenterY(int r);
-bool  atCellCenter(float x,float y,int r,int c,float eps=0.06f);
+inline constexpr float CENTER_EPS = 0.06f;   // cells: the window around a center where actors decide
+bool  atCellCenter(float x,float y,int r,int c,float eps=CENTER_EPS);
+// Signed offset along heading (dx,dy) from the center of the actor's cell, >0 once past it
+float pastCenter(const Actor& a,int dx,int dy);
+
+// Squared distance from (cx,cy) to a move from (x0,y0) to (x1,y1), over the
+// points it reaches after it starts: when it only leaves the point behind,
+// that's the end point, so a zero-length move is the plain end-point test.
+float sweptDistSq(float x0,float y0,float x1,float y1,float cx,float cy);
+
+// Per-world random stream (PCG32 in w.rng). The same seed and stream replay
+// the same game; worlds never share generator state, so threads don't contend.
+void  seedRng(World& w,uint64_t seed,uint64_t stream=0);
+int   randBelow(World& w,int n); // uniform in [0,n), n>0
+
+} // namespace pac
+
+
+// =============================
+// File: include/batch.hpp
+// =============================
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "world.hpp"
+
+namespace pac {
+
+// Worlds per work item: one chunk should stay resident in a typical 256 KiB L2
+inline constexpr std::size_t BATCH_CHUNK_BYTES = 256*1024;
+inline constexpr std::size_t BATCH_CHUNK = BATCH_CHUNK_BYTES/sizeof(World) ? BATCH_CHUNK_BYTES/sizeof(World) : 1;
+
+// Aggregate numbers from one BatchRunner::step call
+struct BatchStats {
+  long long worldTicks=0;   // world steps actually executed (events, for stepEvents)
+  int       gamesFinished=0; // worlds that reached game over / win during the call
+  double    wallSeconds=0.0;
+  double ticksPerSec() const { return wallSeconds>0.0 ? worldTicks/wallSeconds : 0.0; }
+  double gamesPerSec() const { return wallSeconds>0.0 ? gamesFinished/wallSeconds : 0.0; }
+};
+
+// Optional per-tick input hook (e.g. an autopilot), runs right before each step
+using WorldPolicy = void(*)(World&);
+
+// Fixed pool of worker threads advancing many independent worlds at once.
+// Work is split into cache-sized chunks; every thread drains its own slice
+// first and then steals leftover chunks from the other slices. The calling
+// thread takes part as worker 0, so BatchRunner(1) spawns no threads at all.
+class BatchRunner {
+public:
+  explicit BatchRunner(int threads=0); // 0 = one per hardware thread
+  ~BatchRunner();
+  BatchRunner(const BatchRunner&) = delete;
+  BatchRunner& operator=(const BatchRunner&) = delete;
+
+  int threadCount() const { return (int)pool.size()+1; }
+
+  // Advance every unfinished world `ticks` times by dt. Blocks until done.
+  BatchStats step(World* worlds, std::size_t n, float dt, int ticks=1, WorldPolicy policy=nullptr);
+  // Next-event form (events.hpp): advance every unfinished world by `seconds`
+  // of simulated time, one stepToNextEvent() at a time, policy before each.
+  BatchStats stepEvents(World* worlds, std::size_t n, float seconds, WorldPolicy policy=nullptr);
+
+  // Generic form: calls fn(ctx,begin,end) over [0,n) in chunks of `chunk` items.
+  // No allocation per call; fn must be safe to run concurrently on disjoint ranges.
+  void parallelFor(std::size_t n, std::size_t chunk, void (*fn)(void*,std::size_t,std::size_t), void* ctx);
+
+private:
+  struct alignas(64) Slice { std::atomic<std::size_t> next{0}; std::size_t end=0; };
+
+  void workerLoop(int id);
+  void drain(int id);
+
+  std::vector<std::thread> pool;
+  std::unique_ptr<Slice[]> slices;
+  std::mutex m; std::condition_variable wake, done;
+  unsigned generation=0; int pending=0; bool quit=false;
+
+  // Current job (written under m before generation is bumped)
+  std::size_t jobN=0, jobChunk=1;
+  void (*jobFn)(void*,std::size_t,std::size_t)=nullptr; void* jobCtx=nullptr;
+};
+
+} // namespace pac
+
+
+// =============================
+// File: include/events.hpp
+// =============================
+#pragma once
+#include "world.hpp"
+
+namespace pac {
+
+// Next-event stepping for headless runs. Events fall on SIM_DT ticks: every
+// tick on which a fixed-step run could decide, spawn or touch something runs
+// as one, and the ticks between, where every actor only moves in a straight
+// line, are skipped over in a single call:
+//   - Pac-Man starts a tick inside a cell center's atCellCenter() window (the
+//     policy's chance to turn), enters a cell with a pellet, or stops at a wall
+//   - a ghost starts a tick inside the window of a corner or junction
+//     (straight corridor cells are skipped, see LevelHeader::junctionId)
+//   - Pac-Man touches a ghost, a super or the heart
+//   - a spawn timer fires, the ghost speed steps up, the death hold ends
+// Skipped ticks go through coast() and the event tick through step() itself,
+// both with the same per-tick code, so a game played
+// this way is bit for bit the one step(w, SIM_DT) plays, as long as the policy
+// run before each call only acts inside those windows (both autopilots do).
+// pac_headless --compare checks it.
+
+// Advances w to its next event, or by maxDt (in whole ticks, at least one) if
+// nothing happens sooner. Returns the simulated time advanced.
+float stepToNextEvent(World& w, float maxDt);
+
+} // namespace pac
+
+
+// =============================
+// File: include/autopilot.hpp
+// =============================
+#pragma once
+#include "world.hpp"
+
+namespace pac {
+
+// Random-walk player for headless runs: behaves like arrow-key input, turning
+// only at cell centers and keeping its heading while the way is open.
+// Draws from the world's own random stream, so runs replay from the seed.
+void autopilotRandomWalk(World& w);
+
+// Pellet-greedy player: at each cell center, turns toward the nearest pellet
+// (BFS over Pac-Man's moves, ties broken by direction order). It draws nothing
+// and decides the same on every call within one center window, so it plays the
+// same game whatever the step size. The random walk draws a coin on every call,
+// about 3 times per center at SIM_DT, so its games depend on how often it runs.
+void autopilotGreedy(World& w);
+
+} // namespace pac
+
+
+// =============================
+// File: include/profile.hpp
+// =============================
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace pac {
+
+// Scoped frame profiler. Every PAC_PROFILE_SCOPE site owns a static zone;
+// while profiling is on, a scope adds its duration to the zone's total for
+// the current frame and, during a trace capture, logs a complete event into
+// a ring owned by the calling thread. Off by default, where a scope costs one
+// relaxed load. Define PAC_NO_PROFILE to compile the scopes out entirely.
+inline constexpr int PROF_MAX_ZONES   = 32;
+inline constexpr int PROF_WINDOW      = 256;     // frames kept for percentiles
+inline constexpr int PROF_RING_EVENTS = 1<<16;   // trace events kept per thread
+
+extern std::atomic<bool> PROF_ENABLED;
+
+struct ProfZone {
+  const char* name;
+  int id;                               // -1 once PROF_MAX_ZONES is exhausted
+  std::atomic<uint64_t> frameNs{0};     // time spent since the last profileFrameMark
+  explicit ProfZone(const char* zoneName);
+};
+
+uint64_t profileNowNs();                // monotonic, never 0
+void     profileRecord(ProfZone& z, uint64_t t0, uint64_t t1);
+
+class ProfScope {
+public:
+  explicit ProfScope(ProfZone& z) : zone(z), t0(PROF_ENABLED.load(std::memory_order_relaxed) ? profileNowNs() : 0) {}
+  ~ProfScope(){ if(t0) profileRecord(zone, t0, profileNowNs()); }
+  ProfScope(const ProfScope&) = delete;
+  ProfScope& operator=(const ProfScope&) = delete;
+private:
+  ProfZone& zone; uint64_t t0;
+};
+
+void profileEnable(bool on);
+// Closes the frame: the time since the previous mark goes to the "frame" zone
+// and every zone's frame total moves into the percentile window. Call once per
+// presented frame, from one thread.
+void profileFrameMark();
+
+struct ProfRow { const char* name; float lastMs, p50Ms, p99Ms; };
+// One row per zone seen so far, "frame" first; returns the row count
+int  profileSummary(ProfRow* out, int maxRows);
+// Frame times over the window binned into nbins of maxMs/nbins (last bin open-ended)
+void profileFrameHistogram(int* bins, int nbins, float maxMs);
+
+// Chrome trace capture (chrome://tracing, Perfetto). Writing stops the capture.
+void profileCapture(bool on);
+bool profileCapturing();
+bool profileWriteTrace(const char* path);
+
+} // namespace pac
+
+#define PAC_PROF_CAT_(a,b) a##b
+#define PAC_PROF_CAT(a,b)  PAC_PROF_CAT_(a,b)
+#ifndef PAC_NO_PROFILE
+#define PAC_PROFILE_SCOPE(name) \
+  static ::pac::ProfZone PAC_PROF_CAT(pacProfZone_,__LINE__)(name); \
+  ::pac::ProfScope PAC_PROF_CAT(pacProfScope_,__LINE__)(PAC_PROF_CAT(pacProfZone_,__LINE__))
+#else
+#define PAC_PROFILE_SCOPE(name) ((void)0)
+#endif
+
+
+// =============================
+// File: include/replay.hpp
+// =============================
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "logic.hpp"
+#include "world.hpp"
+
+namespace pac {
+
+// Input log, one session = header + records, append-only:
+//   header  "PACR" u8 version u8 0 u16 level, u64 seed (little-endian) 16 bytes
+//   record  ULEB128 tick delta since the previous record, u8 code    ~2 bytes
+// Ticks count fixed SIM_DT steps since the session started. An input with
+// tick t was applied after t steps. The session closes with REC_END at the
+// final tick. Sessions can be concatenated into one archive file. level is
+// the registry index (level.hpp); packs must be loaded in the same order to
+// replay. Version 2 draws power-up cells from the level's spawn list, so
+// version 1 logs no longer reproduce and are refused.
+inline constexpr uint8_t REPLAY_VERSION = 2;
+inline constexpr uint8_t REC_END = 0xff;
+
+// The session's final tick is the last one passed to noteTick() (call it
+// every step) unless close() is given one; the destructor and open() close
+// an open session there, not at its last input.
+class InputRecorder {
+public:
+  ~InputRecorder(){ close(nowTick); }
+  bool open(const char* path, uint64_t seed, int level=0);   // appends a new session
+  bool isOpen() const { return f!=nullptr; }
+  void noteTick(uint64_t tick){ nowTick = tick; }
+  void record(uint64_t tick, InputCode in);
+  void close(uint64_t finalTick);
+private:
+  void put(uint64_t tick, uint8_t code);
+  std::FILE* f=nullptr; uint64_t lastTick=0, nowTick=0;
+};
+
+// One session inside a log buffer (points into it, no copy)
+struct ReplaySession { uint64_t seed; int level; const uint8_t* rec; std::size_t len; };
+// Splits a buffer into sessions; false if it is truncated or not a log
+bool splitSessions(const uint8_t* p, std::size_t n, std::vector<ReplaySession>& out);
+
+struct ReplayResult {
+  bool ok=false;          // log decoded to its REC_END (and its level is loaded)
+  uint64_t ticks=0;       // steps replayed
+  int games=0, score=0, lives=0;
+  uint64_t digest=0;      // hash of the final world, for regression diffs
+};
+// Re-runs a session as fast as possible: same seed, same inputs at the same
+// ticks, and no stepping while the shell would sit in the post-game menu
+ReplayResult runReplay(const ReplaySession& s);
+
+// FNV-1a over the game-visible state (not the padding) of w
+uint64_t worldDigest(const World& w);
+
+} // namespace pac
+
+
+// =============================
+// File: include/mapfile.hpp
+// =============================
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pac {
+
+// Read-only bytes of a file: memory-mapped where the platform allows it (and
+// it was asked for), otherwise read into memory. sequential hints the kernel
+// to read ahead (replay logs); level packs are read at random.
+class MappedFile {
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+  bool open(const char* path, bool useMmap, bool sequential=false);
+  const uint8_t* data() const { return mapped ? mapped : buf.data(); }
+  std::size_t size() const { return n; }
+private:
+  std::vector<uint8_t> buf; const uint8_t* mapped=nullptr; std::size_t n=0;
+};
+
+} // namespace pac
+
+
+// =============================
+// File: include/rewind.hpp
+// =============================
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "logic.hpp"
+#include "world.hpp"
+
+namespace pac {
+
+// Rewind history: a snapshot every REWIND_EVERY_TICKS steps, the last
+// REWIND_SECONDS of play kept in a fixed ring (about 200 worlds, allocated once).
+// One IN_REWIND jumps back REWIND_JUMP_S.
+inline constexpr float REWIND_SECONDS     = 10.0f;
+inline constexpr int   REWIND_EVERY_TICKS = 6;       // 20 snapshots per simulated second
+inline constexpr float REWIND_JUMP_S      = 0.5f;
+inline constexpr int   REWIND_SLOTS = (int)(REWIND_SECONDS/(SIM_DT*REWIND_EVERY_TICKS) + 0.5f);
+
+class RewindBuffer {
+public:
+  RewindBuffer() : slots(new World[REWIND_SLOTS]) {}
+  void clear(){ head=0; count=0; }
+  int  size() const { return count; }
+  // Call after every fixed step; tick = steps taken so far in the session
+  void onStep(const World& w, uint64_t tick){ if(tick % REWIND_EVERY_TICKS == 0) push(w); }
+  void push(const World& w){ slots[head] = w; head = (head+1) % REWIND_SLOTS; if(count<REWIND_SLOTS) count++; }
+  // Restores the snapshot `back` captures ago (the oldest if fewer are kept)
+  // and forgets everything newer; false if there is nothing to go back to
+  bool rewind(World& w, int back);
+private:
+  std::unique_ptr<World[]> slots;
+  int head=0, count=0;
+};
+
+// applyInput() plus the inputs that touch the history: a new game clears it,
+// IN_REWIND jumps back REWIND_JUMP_S. The shell and pac_replay both use this,
+// so rewinds replay exactly.
+void applyInput(World& w, RewindBuffer& history, InputCode in);
+
+} // namespace pac
+
+
+// =============================
+// File: include/handoff.hpp
+// =============================
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace pac {
+
+// Lock-free hand-off between exactly one producer and one consumer thread.
+
+// Triple buffer: the producer fills its back slot and publishes it by swapping
+// it with the middle slot; the consumer swaps the middle slot with its front
+// slot only when something new was published. Neither side ever blocks or
+// sees a half-written value, and the consumer always gets the newest one.
+template<class T>
+class TripleBuffer {
+public:
+  // Producer
+  T&   writeBuffer(){ return slots[back].v; }
+  void publish(){ back = middle.exchange((uint8_t)(back | DIRTY), std::memory_order_acq_rel) & INDEX; }
+  // Consumer: true if a newer value was taken; read() stays valid until the next update()
+  bool update(){
+    if(!(middle.load(std::memory_order_relaxed) & DIRTY)) return false;
+    front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+    return true;
+  }
+  const T& read() const { return slots[front].v; }
+
+private:
+  static constexpr uint8_t INDEX = 3, DIRTY = 4;
+  struct alignas(64) Slot { T v{}; };
+  Slot slots[3];
+  alignas(64) std::atomic<uint8_t> middle{1};
+  alignas(64) uint8_t back = 0;    // producer only
+  alignas(64) uint8_t front = 2;   // consumer only
+};
+
+// Bounded single-producer/single-consumer queue. push() fails when full.
+template<class T, std::size_t N>
+class SpscQueue {
+  static_assert(N && (N & (N-1))==0, "capacity must be a power of two");
+public:
+  bool push(const T& v){
+    std::size_t t = tail.load(std::memory_order_relaxed);
+    if(t - head.load(std::memory_order_acquire) == N) return false;
+    items[t & (N-1)] = v;
+    tail.store(t+1, std::memory_order_release);
+    return true;
+  }
+  bool pop(T& v){
+    std::size_t h = head.load(std::memory_order_relaxed);
+    if(h == tail.load(std::memory_order_acquire)) return false;
+    v = items[h & (N-1)];
+    head.store(h+1, std::memory_order_release);
+    return true;
+  }
+private:
+  T items[N];
+  alignas(64) std::atomic<std::size_t> head{0};   // consumer
+  alignas(64) std::atomic<std::size_t> tail{0};   // producer
+};
+
+} // namespace pac
+
+
+// =============================
+// File: include/vecenv.hpp
+// =============================
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "batch.hpp"
+#include "bitboard.hpp"
+#include "world.hpp"
+
+namespace pac {
+
+// Observation: OBS_PLANES feature planes of ROWS*COLS floats each, row-major
+// like BitBoard (cell r,c at r*COLS+c, row 0 at the top). 1.0 marks a cell.
+enum ObsPlane : int { OBS_WALLS=0, OBS_PELLETS, OBS_PACMAN, OBS_GHOSTS, OBS_SUPERS, OBS_HEART, OBS_PLANES };
+inline constexpr std::size_t OBS_SIZE = (std::size_t)OBS_PLANES*BOARD_CELLS;   // floats per env
+
+// Actions: the four arrow keys (InputCode IN_UP..IN_RIGHT), or keep going
+enum Action : uint8_t { ACT_UP=0, ACT_DOWN, ACT_LEFT, ACT_RIGHT, ACT_NONE, ACT_COUNT };
+
+// N worlds stepped together for reinforcement learning, Gym vector-env style.
+// Every call fills caller-owned arrays in place: obs[N*OBS_SIZE],
+// reward[N], done[N]. An env whose episode ends reports done=1 with the
+// final reward and is reset at once, so obs already shows its next episode.
+// Env i plays episode k from seedRng(seed+i, k): results do not depend on the
+// thread count. step() allocates nothing; work runs on a BatchRunner.
+class VecEnv {
+public:
+  // ticksPerStep: SIM_DT ticks per action (frame skip); maxSteps: truncate
+  // an episode after this many steps (0 = only game over / win end it).
+  // swept: advance each action as one step(w, ticksPerStep*SIM_DT): the same
+  // game as separate ticks, in fewer iterations
+  explicit VecEnv(std::size_t n, int threads=0, int ticksPerStep=4, int maxSteps=0, bool swept=false);
+
+  std::size_t size() const { return worlds.size(); }
+  const World& world(std::size_t i) const { return worlds[i]; }
+
+  void reset(uint64_t seed, float* obs);
+  // actions[N]; reward = score gained during the step
+  void step(const uint8_t* actions, float* obs, float* reward, uint8_t* done);
+
+private:
+  struct Job;
+  static void resetChunk(void* ctx, std::size_t b, std::size_t e);
+  static void stepChunk(void* ctx, std::size_t b, std::size_t e);
+  void startEpisode(std::size_t i);
+  std::size_t chunk() const;
+
+  BatchRunner runner;
+  std::vector<World> worlds;
+  std::vector<uint32_t> episodes, steps;   // per env: episodes started, steps into the current one
+  uint64_t seed = 0;
+  int ticksPerStep, maxSteps;
+  bool swept;
+};
+
+// Write one world's planes to obs[0..OBS_SIZE)
+void writeObservation(const World& w, float* obs);
+
+} // namespace pac
+
+
+// =============================
+// File: include/mcts.hpp
+// =============================
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "batch.hpp"
+#include "logic.hpp"
+#include "rng.hpp"
+#include "world.hpp"
+
+namespace pac {
+
+// Search settings. A tree move is one cell of travel: Pac-Man turns only at
+// cell centers, so each edge picks a direction and steps the cloned world
+// until he reaches the next center (or dies).
+struct MctsConfig {
+  float budgetMs      = 6.0f;  // wall time per decision; 0 = iterations only
+  int   maxIterations = 0;     // per tree; 0 = budget only (both 0: 256)
+  int   rolloutCells  = 16;    // random-walk cells after the tree leaf
+  float explore       = 1.4f;  // UCT exploration constant
+};
+
+struct MctsStats {
+  int    iterations = 0;       // summed over trees
+  int    depth = 0;            // deepest tree path, in cells
+  double ms = 0.0;
+};
+
+// Root-parallel MCTS: one independent tree per worker, each built from its own
+// memcpy clones of the root world, merged by summing root visit counts.
+// Node pools are allocated once up front; a decision allocates nothing.
+class MctsPlanner {
+public:
+  explicit MctsPlanner(const MctsConfig& cfg = {}, int threads=0);   // threads 0 = all cores
+
+  // Arrow input that turns Pac-Man onto the chosen direction, or IN_COUNT
+  // when there is nothing to do this tick: off a cell center, already
+  // decided for this cell, or the chosen way is the current heading.
+  // Call before each step; salt varies the rollouts (e.g. the tick number).
+  // A decision whose budget would run past endBy is skipped, not shortened
+  // or overrun: poll() returns IN_COUNT and tries again on the next call.
+  InputCode poll(const World& w, uint64_t salt,
+                 std::chrono::steady_clock::time_point endBy = std::chrono::steady_clock::time_point::max());
+  // Best direction (DIR_DX/DIR_DY index) from w's cell, DIR_NONE if boxed in
+  int decide(const World& w, uint64_t salt);
+
+  const MctsStats& lastStats() const { return stats; }
+  MctsConfig config;
+
+private:
+  struct Node { int firstChild=-1; float value=0.0f; int visits=0; uint8_t nChildren=0, dir=0; };
+  struct Tree {
+    std::vector<Node> nodes; int used=0;
+    Pcg32 rng; float qMin=0.0f, qMax=0.0f; int iterations=0, depth=0;
+  };
+  struct Job;
+  static void searchChunk(void* ctx, std::size_t b, std::size_t e);
+  void search(Tree& t, const World& root, std::chrono::steady_clock::time_point deadline, int iterCap);
+
+  BatchRunner runner;
+  std::vector<Tree> trees;
+  MctsStats stats;
+  int lastCell = -1;             // cell poll() last decided in
+  float lastX = -1.0f, lastY = -1.0f;
+};
+
+} // namespace pac
+
+
+// =============================
+// File: include/bigmaze.hpp
+// =============================
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "rng.hpp"
+
+namespace pac {
+
+// Runtime-sized mazes for stress and soak runs, up to BIG_MAX_SIDE cells a
+// side. The stock game keeps its compile-time 19x21 board so World stays a
+// memcpy-able value; this is a separate, much larger playground.
+// Cells live in CHUNK x CHUNK tiles with one 64-bit word per tile row, so a
+// tile's walls and pellets are 1 KiB and a cell's neighbours share its lines.
+inline constexpr int CHUNK = 64;
+inline constexpr int BIG_MAX_SIDE = 16384;
+
+struct MazeChunk {
+  uint64_t walls[CHUNK];     // bit c of word r: cell (r,c) inside the tile
+  uint64_t pellets[CHUNK];
+  int      pelletCount = 0;
+  uint32_t version = 0;      // bumped whenever a pellet goes (render caches key on it)
+};
+
+class ChunkedMaze {
+public:
+  // Braided maze: a binary-tree spanning maze over the odd cells (always
+  // connected) plus extra openings so corridors loop like Pac-Man's. Every
+  // open cell starts with a pellet. Each cell is decided from a hash of
+  // (seed,r,c) alone, so the same seed gives the same maze at any size.
+  void generate(int rows, int cols, uint64_t seed);
+
+  int rows() const { return nRows; }
+  int cols() const { return nCols; }
+  int chunkRows() const { return nChunkRows; }
+  int chunkCols() const { return nChunkCols; }
+  const MazeChunk& chunk(int cr,int cc) const { return chunks[(std::size_t)cr*nChunkCols+cc]; }
+
+  // Outside the maze counts as wall
+  bool wall(int r,int c) const {
+    if((unsigned)r>=(unsigned)nRows || (unsigned)c>=(unsigned)nCols) return true;
+    return (chunk(r/CHUNK, c/CHUNK).walls[r%CHUNK]>>(c%CHUNK)) & 1u;
+  }
+  bool pellet(int r,int c) const {
+    if((unsigned)r>=(unsigned)nRows || (unsigned)c>=(unsigned)nCols) return false;
+    return (chunk(r/CHUNK, c/CHUNK).pellets[r%CHUNK]>>(c%CHUNK)) & 1u;
+  }
+  bool eat(int r,int c);               // true if a pellet was there
+  long long pelletsLeft() const { return pellets; }
+  std::size_t bytes() const { return chunks.size()*sizeof(MazeChunk); }
+
+private:
+  int nRows=0, nCols=0, nChunkRows=0, nChunkCols=0;
+  std::vector<MazeChunk> chunks;
+  long long pellets=0;
+};
+
+// Actor on the big maze: at the center of (r,c), t of the way to (r+dy,c+dx).
+// Rows grow downwards here; renderers flip them.
+struct BigActor { int r=1, c=1; int dx=0, dy=0; float t=0.0f; };
+
+// Soak simulation on a ChunkedMaze: Pac-Man (autopilot or steered) and a few
+// ghosts per chunk. Only ghosts within BIG_ACTIVE_RADIUS chunks of Pac-Man
+// move; the rest sleep in per-chunk buckets. A tick therefore costs the same
+// on a 64x64 maze as on a 16384x16384 one.
+inline constexpr int BIG_ACTIVE_RADIUS = 1;     // 3x3 chunks around Pac-Man
+inline constexpr int BIG_GHOSTS_PER_CHUNK = 4;
+
+class BigSim {
+public:
+  void reset(int rows, int cols, uint64_t seed);
+  void step(float dt);
+  // Player turn, taken at the next cell center where it is open; turns the autopilot off
+  void steer(int dx,int dy){ wantDx=dx; wantDy=dy; autopilot=false; }
+
+  const ChunkedMaze& maze() const { return m; }
+  const BigActor& pacman() const { return pac; }
+  const BigActor& ghost(uint32_t i) const { return ghosts[i]; }
+  const std::vector<uint32_t>& ghostsIn(int cr,int cc) const { return buckets[(std::size_t)cr*m.chunkCols()+cc]; }
+  std::size_t ghostCount() const { return ghosts.size(); }
+
+  bool      autopilot = true;
+  long long score = 0, catches = 0, ticks = 0;
+  int       activeGhosts = 0;    // ghosts moved on the last tick
+
+private:
+  void chooseForPac(BigActor& a);
+  void chooseForGhost(BigActor& a);
+  void rebucket(uint32_t i);
+
+  ChunkedMaze m;
+  BigActor pac;
+  std::vector<BigActor> ghosts, homes;
+  std::vector<std::vector<uint32_t>> buckets;   // ghost ids per chunk
+  std::vector<uint32_t> ghostChunk, ghostSlot;  // where each ghost sits in buckets
+  std::vector<uint32_t> scratch;                // active ids for one tick (capacity kept)
+  Pcg32 rng;
+  int wantDx=0, wantDy=0;
+};
 
 } // namespace pac
 
@@ -162,41 +1139,69 @@ bool  atCellCenter(float x,float y,int r,int c,float eps=0.06f);
 // File: include/logic.hpp
 // =============================
 #pragma once
+#include <cstdint>
 #include "types.hpp"
 #include "config.hpp"
+#include "paths.hpp"
+#include "world.hpp"
 
 namespace pac {
 
-// Global actors & ghost dirs (core-owned)
-extern Actor pacman;
-extern Actor ghosts[4];
-extern int   gDx[4];
-extern int   gDy[4];
-
 // Lifecycle
-void resetActors(Runtime& rt);
-void initGhostDirsRandom();
+void resetActors(World& w);
+void initGhostDirsRandom(World& w);
 
-void eatPellet(Runtime& rt);
+void eatPellet(World& w);
 
 // Death flow
-void triggerDeath(Runtime& rt);
-void finalizeDeath(Runtime& rt);
+void triggerDeath(World& w);
+void finalizeDeath(World& w);
 
 // Movement helpers
 void worldToNextCell(int r,int c,int dx,int dy,int& nr,int& nc);
-bool ghostCanGo(int r,int c,int dx,int dy);
-void chooseGhostDirWithChase(int i,int r,int c);
+bool ghostCanGo(const World& w,int r,int c,int dx,int dy);
+// Distances to Pac-Man's cell, a view into the level's path table
+FlowField pacFlowField(const World& w);
+void chooseGhostDirWithChase(World& w,int i,int r,int c);
+// Ghost speed (cells/s) at a given simulated time: steps up every STEP_EVERY_S
+float ghostSpeed(float elapsed);
+// Start of ghost i's update: snap it onto the center line of its heading and,
+// at a cell center, pick its next direction
+void steerGhost(World& w,int i);
+
+// One tick's updates, Pac-Man first. Moves are swept, so neither actor skips
+// a wall, pellet, window or power-up over a long dt, but eating is not cut
+// back to a ghost contact later in the same call: step() keeps each call to
+// one tick. updateGhosts() takes Pac-Man's position before this tick's move
+// (he goes there to here in a straight line at PAC_SPEED, then stands);
+// without it he is taken to stand still.
+void updatePac(World& w, float dt);
+void updateGhosts(World& w, float dt, float pacFromX, float pacFromY);
+void updateGhosts(World& w, float dt);
+
+// Game loop tick: advances the simulated clock by dt seconds. A dt of n
+// whole SIM_DT ticks plays exactly as n step(w, SIM_DT) calls (through
+// stepToNextEvent(), so in fewer iterations); any fraction left is one tick.
+void step(World& w, float dt);
+
+// `ticks` SIM_DT ticks of step() over a stretch where nothing but movement
+// happens: no window, pellet, power-up, wall, touch or timer is reached (see
+// stepToNextEvent()). Moves with step()'s own code, so it stays bit-identical.
+void coast(World& w, int ticks);
 
-// Per-frame updates
-void updatePac(Runtime& rt, float dt);
-void updateGhosts(Runtime& rt, float dt);
+// New game
+void startNewGame(World& w);
 
-// Game loop tick (call from timer callback)
-void step(Runtime& rt);
+// Player inputs that change the game. The shell maps keys/clicks to these and
+// replays feed them back from a log, so both paths go through applyInput().
+// IN_REWIND needs a RewindBuffer, see rewind.hpp; applyInput(w, in) ignores it.
+enum InputCode : uint8_t { IN_UP=0, IN_DOWN, IN_LEFT, IN_RIGHT, IN_PAUSE, IN_NEW_GAME, IN_REWIND, IN_COUNT };
+void applyInput(World& w, InputCode in);
 
-// New game
-void startNewGame(Runtime& rt);
+// Game over stays on screen this long (simulated) before the post-game menu
+inline constexpr float GAME_OVER_HOLD_S = 2.0f;
+// Sets rt.postMenuShown once the hold has elapsed; true on that tick only
+bool finishGameOverHold(World& w);
 
 } // namespace pac
 
@@ -232,7 +1237,7 @@ void initConfig() {
 
 namespace pac {
 
-static const int MAZE_TEMPLATE[ROWS][COLS] = {
+extern const int MAZE_TEMPLATE[ROWS][COLS] = {
   {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
   {1,0,0,0,0,0,0,1,0,0,0,0,1,0,0,0,0,0,1},
   {1,0,1,1,1,0,0,1,0,1,1,0,1,0,0,1,1,0,1},
@@ -256,233 +1261,1598 @@ static const int MAZE_TEMPLATE[ROWS][COLS] = {
   {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
 };
 
-int MAZE[ROWS][COLS] = {};
-
-void copyMazeFromTemplate(){
-  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++) MAZE[r][c]=MAZE_TEMPLATE[r][c];
-}
+void copyMazeFromTemplate(World& w){ w.pellets = levelOf(w).planes().pellets0; }
 
-int countDots(){
-  int pelletsTotal=0;
-  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++) if(MAZE[r][c]==DOTCELL) pelletsTotal++;
-  return pelletsTotal;
-}
+int countDots(const World& w){ return w.pellets.count(); }
 
 } // namespace pac
 
 
 // =============================
-// File: src/util.cpp
+// File: src/paths.cpp
 // =============================
-#include <cmath>
-#include "util.hpp"
-#include "maze.hpp"
+#include <algorithm>
+#include <vector>
+#include "paths.hpp"
 
 namespace pac {
 
-int yToRow(float y){ return ROWS-1-(int)std::floor(y); }
+int pathCellCount(const int maze[ROWS][COLS]){
+  int n=0;
+  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++) n += maze[r][c]!=WALL;
+  return n;
+}
+
+void buildPathTable(const int maze[ROWS][COLS], int16_t* index, int16_t* cellOf, int16_t* nbr, uint16_t* dist, uint8_t* next){
+  int n=0;
+  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++){
+    if(maze[r][c]==WALL){ index[r*COLS+c] = -1; continue; }
+    cellOf[n] = (int16_t)(r*COLS+c); index[r*COLS+c] = (int16_t)n++;
+  }
+  auto idAt = [&](int r,int c){ return (r<0||r>=ROWS||c<0||c>=COLS) ? -1 : index[r*COLS+c]; };
+  for(int id=0; id<n; id++){
+    int r=cellOf[id]/COLS, c=cellOf[id]%COLS;
+    // dy>0 is up on screen, i.e. one row lower in the array
+    for(int d=0; d<4; d++) nbr[id*4+d] = (int16_t)idAt(r-DIR_DY[d], c+DIR_DX[d]);
+  }
+
+  std::fill(dist, dist+(std::size_t)n*n, DIST_FAR);
+  std::fill(next, next+(std::size_t)n*n, DIR_NONE);
+  std::vector<int> queue(n);
+  for(int s=0; s<n; s++){
+    uint16_t* ds = &dist[(std::size_t)s*n];
+    uint8_t*  ns = &next[(std::size_t)s*n];
+    int head=0, tail=0; queue[tail++]=s; ds[s]=0;
+    while(head<tail){
+      int u=queue[head++];
+      for(int d=0; d<4; d++){
+        int v=nbr[u*4+d];
+        if(v<0 || ds[v]!=DIST_FAR) continue;
+        ds[v] = (uint16_t)(ds[u]+1);
+        ns[v] = (u==s) ? (uint8_t)d : ns[u];
+        queue[tail++]=v;
+      }
+    }
+  }
+}
+
+} // namespace pac
+
+
+// =============================
+// File: src/level.cpp
+// =============================
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include "level.hpp"
+#include "mapfile.hpp"
+#include "maze.hpp"
+
+namespace pac {
+
+static constexpr std::size_t PACK_HEADER_BYTES = 16;
+
+static std::size_t align8(std::size_t n){ return (n+7) & ~(std::size_t)7; }
+
+// Section offsets of a record with n walkable cells
+struct LevelLayout { std::size_t cellOf, nbr, dist, next, bytes; };
+static LevelLayout levelLayout(std::size_t n){
+  LevelLayout l; std::size_t at = sizeof(LevelHeader);
+  l.cellOf = at; at = align8(at + n*2);
+  l.nbr    = at; at = align8(at + n*8);
+  l.dist   = at; at = align8(at + n*n*2);
+  l.next   = at; at = align8(at + n*n);
+  l.bytes  = at;
+  return l;
+}
+
+// Bit d set if the cell DIR_DX/DY[d] away is on the board and not in `blocked`; 0 on blocked cells
+static uint8_t openMask(const BitBoard& blocked, int r, int c){
+  auto open = [&](int r,int c){ return r>=0 && r<ROWS && c>=0 && c<COLS && !blocked.test(r,c); };
+  if(!open(r,c)) return 0;
+  uint8_t m=0;
+  for(int d=0; d<4; d++) if(open(r-DIR_DY[d], c+DIR_DX[d])) m |= (uint8_t)(1u<<d);
+  return m;
+}
+
+// Junctions are walkable cells with other than two exits; each run follows
+// the forced moves from one cell until it reaches a junction
+static void buildJunctionGraph(LevelHeader& h){
+  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++){
+    int cell=r*COLS+c; h.junctionId[cell] = -1;
+    if(h.planes.walls.test(r,c)) continue;
+    h.ghostMask[cell] = openMask(h.planes.walls, r, c);
+    if(popcount64(h.ghostMask[cell])!=2) h.junctionId[cell] = (int16_t)h.junctionCount++;
+  }
+  for(int cell=0; cell<BOARD_CELLS; cell++) for(int d=0; d<4; d++){
+    CorridorRun& run = h.runs[cell*4+d]; run = {-1, 0, (uint8_t)d};
+    if(!(h.ghostMask[cell]>>d & 1u)) continue;
+    int at=cell, dir=d;
+    for(int len=1; len<=UINT8_MAX; len++){
+      at += -DIR_DY[dir]*COLS + DIR_DX[dir];
+      if(h.junctionId[at]>=0){ run = {(int16_t)at, (uint8_t)len, (uint8_t)dir}; break; }
+      dir = ctz64(h.ghostMask[at] & ~(1u<<(dir^1)));   // the one way on
+    }
+  }
+}
+
+void buildLevel(const int maze[ROWS][COLS], const char* name, std::vector<uint8_t>& out){
+  const int n = pathCellCount(maze);
+  const LevelLayout l = levelLayout((std::size_t)n);
+  out.assign(l.bytes, 0);
+  uint8_t* base = out.data();
+  LevelHeader& h = *(LevelHeader*)base;
+  std::snprintf(h.name, sizeof(h.name), "%s", name);
+  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++){
+    if(maze[r][c]==WALL)    { h.planes.walls.set(r,c); h.planes.pacBlocked.set(r,c); }
+    if(maze[r][c]==GATE)    { h.planes.gates.set(r,c); h.planes.pacBlocked.set(r,c); }
+    if(maze[r][c]==DOTCELL) h.planes.pellets0.set(r,c);
+  }
+  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++){
+    if(h.planes.pacBlocked.test(r,c)) continue;
+    h.nbrMask[r*COLS+c] = openMask(h.planes.pacBlocked, r, c);
+    h.spawnCells[h.spawnCount++] = (uint16_t)(r*COLS+c);
+  }
+  h.pelletCount = h.planes.pellets0.count();
+  h.nCells = n; h.bytes = (uint32_t)l.bytes;
+  buildPathTable(maze, h.pathIndex, (int16_t*)(base+l.cellOf), (int16_t*)(base+l.nbr),
+                 (uint16_t*)(base+l.dist), base+l.next);
+  const uint16_t* dist = (const uint16_t*)(base+l.dist);
+  h.ghostConnected = std::find(dist, dist+(std::size_t)n*n, DIST_FAR)==dist+(std::size_t)n*n;
+  buildJunctionGraph(h);
+}
+
+// Every entry the simulator uses as an index, range-checked once at load so a
+// corrupt pack is refused instead of read out of bounds mid-game. O(cells +
+// nCells); the n*n dist/next tables are trusted, checking them costs a rebuild.
+static bool indicesInRange(const LevelHeader& h, const int16_t* cellOf, const int16_t* nbr){
+  const int n = h.nCells;
+  if(h.junctionCount<0 || h.junctionCount>BOARD_CELLS) return false;
+  for(int i=0;i<BOARD_CELLS;i++)
+    if(h.pathIndex[i]<-1 || h.pathIndex[i]>=n || h.junctionId[i]<-1 || h.junctionId[i]>=h.junctionCount) return false;
+  for(int i=0;i<h.spawnCount;i++) if(h.spawnCells[i]>=BOARD_CELLS) return false;
+  for(int i=0;i<BOARD_CELLS*4;i++) if(h.runs[i].end<-1 || h.runs[i].end>=BOARD_CELLS || h.runs[i].arrive>=4) return false;
+  for(int i=0;i<n;i++) if(cellOf[i]<0 || cellOf[i]>=BOARD_CELLS) return false;
+  for(int i=0;i<4*n;i++) if(nbr[i]<-1 || nbr[i]>=n) return false;
+  return true;
+}
+
+// The direction masks are followed with ctz() and DIR_DX/DY[bit] and never
+// bounds-checked again, so they must be exactly what the planes give, as must
+// the junction ids, the pellet count the win test uses and ghostConnected
+// (a flood over ghostMask, the dist table's own adjacency). O(cells).
+static bool matchesPlanes(const LevelHeader& h){
+  if(h.pelletCount!=h.planes.pellets0.count()) return false;
+  int16_t queue[BOARD_CELLS]; BitBoard seen; int head=0, tail=0, walkable=0;
+  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++){
+    const int cell=r*COLS+c; const uint8_t g = openMask(h.planes.walls, r, c);
+    const bool walk = !h.planes.walls.test(r,c);
+    if(h.nbrMask[cell]!=openMask(h.planes.pacBlocked, r, c) || h.ghostMask[cell]!=g) return false;
+    if((h.junctionId[cell]>=0) != (walk && popcount64(g)!=2)) return false;
+    if(walk && walkable++==0){ seen.set(r,c); queue[tail++] = (int16_t)cell; }
+  }
+  while(head<tail){
+    const int u=queue[head++];
+    for(unsigned m=h.ghostMask[u]; m; m&=m-1){
+      const int d=ctz64(m), v=u - DIR_DY[d]*COLS + DIR_DX[d];
+      if(!seen.test(v/COLS, v%COLS)){ seen.set(v/COLS, v%COLS); queue[tail++] = (int16_t)v; }
+    }
+  }
+  return h.ghostConnected==(tail==walkable ? 1 : 0);
+}
+
+bool viewLevel(const uint8_t* p, std::size_t n, Level& out){
+  if(((uintptr_t)p & 7) || n < sizeof(LevelHeader)) return false;
+  const LevelHeader* h = (const LevelHeader*)p;
+  if(h->nCells<0 || h->nCells>BOARD_CELLS || h->spawnCount<0 || h->spawnCount>BOARD_CELLS) return false;
+  const LevelLayout l = levelLayout((std::size_t)h->nCells);
+  if(h->bytes!=l.bytes || l.bytes>n) return false;
+  if(!indicesInRange(*h, (const int16_t*)(p+l.cellOf), (const int16_t*)(p+l.nbr)) || !matchesPlanes(*h)) return false;
+  out.hdr = h;
+  out.paths.nCells = h->nCells;
+  out.paths.index  = h->pathIndex;
+  out.paths.cellOf = (const int16_t*)(p+l.cellOf);
+  out.paths.nbr    = (const int16_t*)(p+l.nbr);
+  out.paths.dist   = (const uint16_t*)(p+l.dist);
+  out.paths.next   = p+l.next;
+  return true;
+}
+
+bool writeLevelPack(const char* path, const std::vector<std::vector<uint8_t>>& records){
+  std::FILE* f = std::fopen(path, "wb"); if(!f) return false;
+  uint8_t h[PACK_HEADER_BYTES] = {'P','A','C','L', LEVEL_PACK_VERSION, (uint8_t)ROWS, (uint8_t)COLS, 0};
+  uint32_t count = (uint32_t)records.size(); std::memcpy(h+8, &count, 4);
+  std::vector<uint64_t> offsets; uint64_t at = PACK_HEADER_BYTES + 8*(uint64_t)count;
+  for(const auto& r : records){ offsets.push_back(at); at += align8(r.size()); }
+  bool ok = std::fwrite(h, 1, sizeof(h), f)==sizeof(h)
+         && std::fwrite(offsets.data(), 8, count, f)==count;
+  static const uint8_t pad[8] = {};
+  for(const auto& r : records){
+    if(!ok) break;
+    ok = std::fwrite(r.data(), 1, r.size(), f)==r.size()
+      && std::fwrite(pad, 1, align8(r.size())-r.size(), f)==align8(r.size())-r.size();
+  }
+  return std::fclose(f)==0 && ok;
+}
+
+// ===== registry
+struct Registry {
+  std::vector<uint8_t> builtin;                    // level 0's record
+  std::vector<Level> levels;
+  std::vector<std::unique_ptr<MappedFile>> packs;  // kept mapped for the run
+  Registry(){
+    levels.emplace_back();
+    buildLevel(MAZE_TEMPLATE, "classic", builtin);
+    viewLevel(builtin.data(), builtin.size(), levels[0]);
+  }
+};
+static Registry& registry(){ static Registry r; return r; }
+
+// Constant-initialised, so level() called from another file's static
+// initializer finds nullptr and builds level 0 through initLevelTable()
+const Level* LEVEL_TABLE      = nullptr;
+int          LEVEL_TABLE_SIZE = 0;
+
+const Level* initLevelTable(){
+  Registry& reg = registry();
+  if(!LEVEL_TABLE){ LEVEL_TABLE = reg.levels.data(); LEVEL_TABLE_SIZE = (int)reg.levels.size(); }
+  return LEVEL_TABLE;
+}
+// Set before main() in any case, so worker threads never take the slow path
+static const Level* const LEVEL_TABLE_READY = initLevelTable();
+
+int loadLevelPack(const char* path, bool useMmap){
+  std::unique_ptr<MappedFile> file(new MappedFile);
+  if(!file->open(path, useMmap)) return -1;
+  const uint8_t* p = file->data(); const std::size_t n = file->size();
+  if(n < PACK_HEADER_BYTES || std::memcmp(p,"PACL",4)!=0 || p[4]!=LEVEL_PACK_VERSION || p[5]!=ROWS || p[6]!=COLS) return -1;
+  uint32_t count; std::memcpy(&count, p+8, 4);
+  if(count==0 || (n-PACK_HEADER_BYTES)/8 < count) return -1;
+  std::vector<Level> found(count);
+  for(uint32_t i=0;i<count;i++){
+    uint64_t off; std::memcpy(&off, p+PACK_HEADER_BYTES+8*(std::size_t)i, 8);
+    if(off>=n || !viewLevel(p+off, n-(std::size_t)off, found[i])) return -1;
+  }
+  Registry& reg = registry(); initLevelTable();
+  int first = (int)reg.levels.size();
+  reg.levels.insert(reg.levels.end(), found.begin(), found.end());
+  reg.packs.push_back(std::move(file));
+  LEVEL_TABLE = reg.levels.data(); LEVEL_TABLE_SIZE = (int)reg.levels.size();
+  return first;
+}
+
+} // namespace pac
+
+
+// =============================
+// File: src/util.cpp
+// =============================
+#include <cmath>
+#include "util.hpp"
+#include "maze.hpp"
+
+namespace pac {
+
+int yToRow(float y){ return ROWS-1-(int)std::floor(y); }
 int xToCol(float x){ return (int)std::floor(x); }
 
-bool blockedForPac(int r,int c){
-  return (r<0||r>=ROWS||c<0||c>=COLS||MAZE[r][c]==WALL||MAZE[r][c]==GATE);
+// One unsigned range check plus one bit test against the level's shared planes
+bool blockedForPac(const World& w,int r,int c){
+  return (unsigned)r>=(unsigned)ROWS || (unsigned)c>=(unsigned)COLS || levelOf(w).planes().pacBlocked.test(r,c);
+}
+bool blockedForGhostCell(const World& w,int r,int c){
+  return (unsigned)r>=(unsigned)ROWS || (unsigned)c>=(unsigned)COLS || levelOf(w).planes().walls.test(r,c);
+}
+
+float clampf(float v,float lo,float hi){ return v<lo?lo:(v>hi?hi:v); }
+
+float cellCenterX(int c){ return c + 0.5f; }
+float cellCenterY(int r){ return (ROWS-1-r) + 0.5f; }
+
+bool atCellCenter(float x,float y,int r,int c,float eps){
+  return std::fabs(x - cellCenterX(c)) < eps && std::fabs(y - cellCenterY(r)) < eps;
+}
+
+float pastCenter(const Actor& a,int dx,int dy){
+  return dx ? (a.x - cellCenterX(xToCol(a.x)))*dx : (a.y - cellCenterY(yToRow(a.y)))*dy;
+}
+
+float sweptDistSq(float x0,float y0,float x1,float y1,float cx,float cy){
+  float ux=x1-x0, uy=y1-y0, dx=cx-x0, dy=cy-y0;
+  float along = dx*ux + dy*uy, uu = ux*ux + uy*uy;
+  if(along<=0.0f || along>=uu){ float ex=cx-x1, ey=cy-y1; return ex*ex + ey*ey; }
+  float s = along/uu, ex = dx - ux*s, ey = dy - uy*s;
+  return ex*ex + ey*ey;
+}
+
+void seedRng(World& w,uint64_t seed,uint64_t stream){ pcgSeed(w.rng, seed, stream); }
+int randBelow(World& w,int n){ return (int)pcgBelow(w.rng, (uint32_t)n); }
+
+} // namespace pac
+
+
+// =============================
+// File: src/batch.cpp
+// =============================
+#include <algorithm>
+#include <chrono>
+#include "batch.hpp"
+#include "events.hpp"
+#include "logic.hpp"
+
+namespace pac {
+
+BatchRunner::BatchRunner(int threads){
+  if(threads<=0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+  slices.reset(new Slice[threads]);
+  for(int i=1;i<threads;i++) pool.emplace_back(&BatchRunner::workerLoop, this, i);
+}
+
+BatchRunner::~BatchRunner(){
+  { std::lock_guard<std::mutex> lk(m); quit=true; }
+  wake.notify_all();
+  for(auto& t:pool) t.join();
+}
+
+void BatchRunner::workerLoop(int id){
+  unsigned seen=0;
+  for(;;){
+    { std::unique_lock<std::mutex> lk(m);
+      wake.wait(lk, [&]{ return quit || generation!=seen; });
+      if(quit) return;
+      seen=generation; }
+    drain(id);
+    { std::lock_guard<std::mutex> lk(m); if(--pending==0) done.notify_one(); }
+  }
+}
+
+// Own slice first, then walk the others and steal whatever is left
+void BatchRunner::drain(int id){
+  int T=threadCount();
+  for(int k=0;k<T;k++){
+    Slice& s = slices[(id+k)%T];
+    for(;;){
+      std::size_t i = s.next.fetch_add(1, std::memory_order_relaxed);
+      if(i>=s.end) break;
+      std::size_t b=i*jobChunk, e=std::min(jobN, b+jobChunk);
+      jobFn(jobCtx, b, e);
+    }
+  }
+}
+
+void BatchRunner::parallelFor(std::size_t n, std::size_t chunk, void (*fn)(void*,std::size_t,std::size_t), void* ctx){
+  if(n==0) return;
+  if(chunk==0) chunk=1;
+  int T=threadCount();
+  std::size_t chunks=(n+chunk-1)/chunk;
+  { std::lock_guard<std::mutex> lk(m);
+    jobN=n; jobChunk=chunk; jobFn=fn; jobCtx=ctx;
+    for(int t=0;t<T;t++){
+      slices[t].next.store(chunks*t/T, std::memory_order_relaxed);
+      slices[t].end = chunks*(t+1)/T;
+    }
+    pending=T-1; generation++; }
+  wake.notify_all();
+  drain(0);
+  std::unique_lock<std::mutex> lk(m);
+  done.wait(lk, [&]{ return pending==0; });
+}
+
+namespace {
+struct StepJob {
+  World* worlds; float dt; int ticks; WorldPolicy policy;
+  std::atomic<long long> worldTicks{0}; std::atomic<int> finished{0};
+};
+
+void stepChunk(void* ctx, std::size_t b, std::size_t e){
+  StepJob& job = *static_cast<StepJob*>(ctx);
+  long long ticks=0; int finished=0;
+  for(std::size_t i=b;i<e;i++){
+    World& w = job.worlds[i];
+    if(w.rt.gameOver || w.rt.winGame) continue;
+    for(int t=0;t<job.ticks;t++){
+      if(job.policy) job.policy(w);
+      step(w, job.dt); ticks++;
+      if(w.rt.gameOver || w.rt.winGame){ finished++; break; }
+    }
+  }
+  job.worldTicks.fetch_add(ticks, std::memory_order_relaxed);
+  job.finished.fetch_add(finished, std::memory_order_relaxed);
+}
+} // namespace
+
+namespace {
+struct EventJob {
+  World* worlds; float seconds; WorldPolicy policy;
+  std::atomic<long long> events{0}; std::atomic<int> finished{0};
+};
+
+void eventChunk(void* ctx, std::size_t b, std::size_t e){
+  EventJob& job = *static_cast<EventJob*>(ctx);
+  long long events=0; int finished=0;
+  for(std::size_t i=b;i<e;i++){
+    World& w = job.worlds[i];
+    if(w.rt.gameOver || w.rt.winGame) continue;
+    for(float left=job.seconds; left>0.5f*SIM_DT; ){
+      if(job.policy) job.policy(w);
+      left -= stepToNextEvent(w, left); events++;
+      if(w.rt.gameOver || w.rt.winGame){ finished++; break; }
+    }
+  }
+  job.events.fetch_add(events, std::memory_order_relaxed);
+  job.finished.fetch_add(finished, std::memory_order_relaxed);
+}
+} // namespace
+
+BatchStats BatchRunner::step(World* worlds, std::size_t n, float dt, int ticks, WorldPolicy policy){
+  StepJob job; job.worlds=worlds; job.dt=dt; job.ticks=ticks; job.policy=policy;
+  auto t0 = std::chrono::steady_clock::now();
+  parallelFor(n, BATCH_CHUNK, stepChunk, &job);
+  BatchStats st;
+  st.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  st.worldTicks = job.worldTicks.load();
+  st.gamesFinished = job.finished.load();
+  return st;
+}
+
+BatchStats BatchRunner::stepEvents(World* worlds, std::size_t n, float seconds, WorldPolicy policy){
+  EventJob job; job.worlds=worlds; job.seconds=seconds; job.policy=policy;
+  auto t0 = std::chrono::steady_clock::now();
+  parallelFor(n, BATCH_CHUNK, eventChunk, &job);
+  BatchStats st;
+  st.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  st.worldTicks = job.events.load();
+  st.gamesFinished = job.finished.load();
+  return st;
+}
+
+} // namespace pac
+
+
+// =============================
+// File: src/events.cpp
+// =============================
+#include <algorithm>
+#include <cmath>
+#include "events.hpp"
+#include "logic.hpp"
+#include "maze.hpp"
+#include "powerups.hpp"
+#include "util.hpp"
+#include "profile.hpp"
+
+namespace pac {
+
+static constexpr int   NEVER = 1<<30;   // ticks
+// Tick counts round up less this much: an event a tick early only finds
+// nothing to do, one a tick late would skip the tick that acts
+static constexpr float EARLY = 1e-3f;
+
+// Whole ticks, at least one, until something `per` a tick apart covers `dist`
+static int ticksFor(float dist, float per){
+  if(per<=0.0f) return NEVER;
+  float k = std::ceil(dist/per - EARLY);
+  return k<1.0f ? 1 : k>=(float)NEVER ? NEVER : (int)k;
+}
+
+// Earliest t >= 0 with |d + v t| <= r, NEVER (as seconds) if the paths never come that close
+static float timeToContact(float dx, float dy, float vx, float vy, float r){
+  float c = dx*dx + dy*dy - r*r; if(c<=0.0f) return 0.0f;
+  float a = vx*vx + vy*vy, b = dx*vx + dy*vy;
+  if(a<=0.0f || b>=0.0f) return (float)NEVER;
+  float disc = b*b - a*c; if(disc<0.0f) return (float)NEVER;
+  return (-b - std::sqrt(disc))/a;
+}
+
+// Pac-Man's heading as unit (dx,dy), (0,0) when standing still
+static void pacHeading(const Actor& p, int& dx, int& dy){
+  dx = p.vx>0.5f ? 1 : p.vx<-0.5f ? -1 : 0;
+  dy = dx ? 0 : p.vy>0.5f ? 1 : p.vy<-0.5f ? -1 : 0;
+}
+
+// Ticks until Pac-Man starts a tick inside a center window (where the policy
+// acts, so every tick in one is an event), enters a cell with a pellet, or
+// stops at the wall ahead. walk: ticks he can still move, NEVER if unbounded.
+static int pacTicks(const World& w, int dx, int dy, float step, int& walk){
+  const Actor& p = w.pacman; int r=yToRow(p.y), c=xToCol(p.x);
+  walk = NEVER;
+  if(atCellCenter(p.x, p.y, r, c)) return 1;
+  if(!dx && !dy) return NEVER;
+  const float a = pastCenter(p, dx, dy);
+  const bool windows = (dx ? std::fabs(p.y - cellCenterY(r)) : std::fabs(p.x - cellCenterX(c))) < CENTER_EPS;
+  int nr,nc; worldToNextCell(r, c, dx, dy, nr, nc);
+  int k = NEVER;
+  if(blockedForPac(w,nr,nc)){
+    // Count the moves step() still makes, with its adds, up to the wall
+    float v = dx ? p.x : p.y; const float dv = dx ? p.vx*PAC_SPEED*SIM_DT : p.vy*PAC_SPEED*SIM_DT;
+    for(walk=0; (dx ? xToCol(v+dv)==c : yToRow(v+dv)==r); walk++) v += dv;
+    if(walk==0) return NEVER;
+    k = walk;
+  }
+  else k = ticksFor(w.pellets.test(nr,nc) || !windows ? 0.5f - a : 1.0f - a - CENTER_EPS, step);
+  if(windows && a <= -CENTER_EPS) k = std::min(k, ticksFor(-a - CENTER_EPS, step));
+  return k;
+}
+
+// Ticks until ghost i starts a tick inside a window where steerGhost() may
+// turn it; straight corridor cells never do (LevelHeader::junctionId)
+static int ghostTicks(const World& w, int i, float step){
+  const Actor& g = w.ghosts[i];
+  int k = dirIndex(w.gDx[i], w.gDy[i]); if(k==DIR_NONE) return 1;   // stopped: re-steered every tick
+  int r=yToRow(g.y), c=xToCol(g.x);
+  const LevelHeader& lv = *levelOf(w).hdr;
+  const unsigned straight = (1u<<k) | (1u<<(k^1));
+  auto turns = [&](int r,int c){ return !(lv.ghostConnected && lv.ghostMask[r*COLS+c]==straight && lv.junctionId[r*COLS+c]<0); };
+  const float a = pastCenter(g, DIR_DX[k], DIR_DY[k]);
+  if(a > -CENTER_EPS && a < CENTER_EPS && turns(r,c)) return 1;
+  float d = -a - CENTER_EPS;
+  if(a > -CENTER_EPS || !turns(r,c)){ d += 1.0f; r -= DIR_DY[k]; c += DIR_DX[k]; }
+  while(r>=0 && r<ROWS && c>=0 && c<COLS && !turns(r,c)){ d += 1.0f; r -= DIR_DY[k]; c += DIR_DX[k]; }
+  return ticksFor(d, step);
+}
+
+// Ticks from now to the next event: the k-th tick is the first that may do
+// more than move everyone in a straight line
+static int eventTicks(const World& w){
+  const Runtime& rt = w.rt;
+  if(rt.deathActive) return ticksFor(rt.tDeathStart + 1.0f - rt.simTime, SIM_DT);
+  if(rt.paused) return NEVER;
+
+  const float t0 = rt.simTime, gs = ghostSpeed(t0 + SIM_DT);
+  const float gStep = gs*SIM_DT, pStep = PAC_SPEED*SIM_DT;
+  const Actor& pac = w.pacman;
+  int pdx, pdy; pacHeading(pac, pdx, pdy);
+  int walk, k = pacTicks(w, pdx, pdy, pStep, walk);
+  const bool pacMoves = (pdx||pdy) && walk>0;
+  if(pacMoves) k = std::min(k, walk);
+  const float pvx = pacMoves ? pdx*PAC_SPEED : 0.0f, pvy = pacMoves ? pdy*PAC_SPEED : 0.0f;
+  for(int i=0;i<4;i++){
+    k = std::min(k, ghostTicks(w, i, gStep));
+    const Actor& g = w.ghosts[i];
+    float rr = g.radius + pac.radius - 0.04f;
+    k = std::min(k, ticksFor(timeToContact(g.x-pac.x, g.y-pac.y, w.gDx[i]*gs-pvx, w.gDy[i]*gs-pvy, rr), SIM_DT));
+  }
+  for(const SuperFood& s : w.supers) if(s.active)
+    k = std::min(k, ticksFor(timeToContact(cellCenterX(s.c)-pac.x, cellCenterY(s.r)-pac.y, -pvx, -pvy, pac.radius+0.30f), SIM_DT));
+  if(w.heart.active)
+    k = std::min(k, ticksFor(timeToContact(cellCenterX(w.heart.c)-pac.x, cellCenterY(w.heart.r)-pac.y, -pvx, -pvy, pac.radius+0.28f), SIM_DT));
+  k = std::min(k, ticksFor(rt.lastSuperSpawnAt + SUPER_SPAWN_INTERVAL - t0, SIM_DT));
+  if(!w.heart.active) k = std::min(k, ticksFor(rt.lastHeartSpawnAt + HEART_SPAWN_INTERVAL - t0, SIM_DT));
+  // Every tick of the event runs at the first tick's ghost speed
+  const float nextSpeedAt = (float)((int(t0 + SIM_DT)/STEP_EVERY_S + 1)*STEP_EVERY_S);
+  return std::max(1, std::min(k, ticksFor(nextSpeedAt - t0, SIM_DT) - 1));
+}
+
+float stepToNextEvent(World& w, float maxDt){
+  PAC_PROFILE_SCOPE("stepToNextEvent");
+  if(maxDt<=0.0f) return 0.0f;
+  const int k = std::min(std::max(1, (int)(maxDt/SIM_DT + EARLY)), eventTicks(w));
+  // The first k-1 ticks only move everyone in a straight line (steering
+  // outside a window changes nothing); the last is a plain step()
+  coast(w, k-1);
+  step(w, SIM_DT);
+  return k*SIM_DT;
+}
+
+} // namespace pac
+
+
+// =============================
+// File: src/autopilot.cpp
+// =============================
+#include <algorithm>
+#include "autopilot.hpp"
+#include "logic.hpp"
+#include "maze.hpp"
+#include "util.hpp"
+
+namespace pac {
+
+void autopilotRandomWalk(World& w){
+  const Runtime& rt = w.rt; Actor& pacman = w.pacman;
+  if(rt.gameOver || rt.winGame || rt.deathActive) return;
+  int r=yToRow(pacman.y), c=xToCol(pacman.x);
+  if(!atCellCenter(pacman.x, pacman.y, r, c)) return;
+  int nr,nc; worldToNextCell(r,c,(int)pacman.vx,(int)pacman.vy,nr,nc);
+  bool stuck = (pacman.vx==0 && pacman.vy==0) || blockedForPac(w,nr,nc);
+  if(!stuck && randBelow(w,4)) return;
+  struct D{int dx,dy;}; D dirs[4]={{1,0},{-1,0},{0,1},{0,-1}};
+  for(int tries=0; tries<8; ++tries){
+    D d=dirs[randBelow(w,4)];
+    worldToNextCell(r,c,d.dx,d.dy,nr,nc);
+    if(blockedForPac(w,nr,nc)) continue;
+    pacman.vx=(float)d.dx; pacman.vy=(float)d.dy; return;
+  }
+}
+
+void autopilotGreedy(World& w){
+  const Runtime& rt = w.rt; Actor& pacman = w.pacman;
+  if(rt.gameOver || rt.winGame || rt.deathActive) return;
+  int r=yToRow(pacman.y), c=xToCol(pacman.x);
+  if(!atCellCenter(pacman.x, pacman.y, r, c)) return;
+  const LevelHeader& lv = *levelOf(w).hdr;
+  const int from = r*COLS+c;
+  int16_t seen[BOARD_CELLS]; std::fill(seen, seen+BOARD_CELLS, (int16_t)-1);   // first move toward the cell
+  int queue[BOARD_CELLS], head=0, tail=0;
+  queue[tail++] = from; seen[from] = DIR_NONE;
+  while(head<tail){
+    int u = queue[head++];
+    if(u!=from && w.pellets.test(u/COLS, u%COLS)){ pacman.vx=(float)DIR_DX[seen[u]]; pacman.vy=(float)DIR_DY[seen[u]]; return; }
+    for(int d=0; d<4; d++) if(lv.nbrMask[u]>>d & 1u){
+      int v = u - DIR_DY[d]*COLS + DIR_DX[d];
+      if(seen[v]<0){ seen[v] = (int16_t)(u==from ? d : seen[u]); queue[tail++] = v; }
+    }
+  }
+}
+
+} // namespace pac
+
+
+// =============================
+// File: src/profile.cpp
+// =============================
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "profile.hpp"
+
+namespace pac {
+
+std::atomic<bool> PROF_ENABLED{false};
+
+// ===== zone registry (append-only, zones are statics and never die)
+static ProfZone*        zones[PROF_MAX_ZONES];
+static std::atomic<int> zoneCount{0};
+
+ProfZone::ProfZone(const char* zoneName) : name(zoneName), id(-1) {
+  int i = zoneCount.load();
+  while(i<PROF_MAX_ZONES && !zoneCount.compare_exchange_weak(i, i+1)) {}
+  if(i<PROF_MAX_ZONES){ id=i; zones[i]=this; }
+}
+
+static ProfZone FRAME_ZONE("frame");
+
+uint64_t profileNowNs(){
+  static const auto epoch = std::chrono::steady_clock::now();
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-epoch).count() + 1;
+}
+
+// ===== per-thread trace rings. Owned by the registry so events from worker
+// threads outlive the threads; written only by their owner.
+struct TraceEvent { uint64_t t0, t1; int zone; };
+struct TraceRing {
+  int tid;
+  std::atomic<uint64_t> written{0};
+  std::unique_ptr<TraceEvent[]> ev{new TraceEvent[PROF_RING_EVENTS]};
+};
+static std::mutex ringMutex;
+static std::vector<std::unique_ptr<TraceRing>> rings;
+static std::atomic<bool> capturing{false};
+
+static TraceRing& threadRing(){
+  thread_local TraceRing* mine = nullptr;
+  if(!mine){
+    std::lock_guard<std::mutex> lk(ringMutex);
+    rings.emplace_back(new TraceRing);
+    mine = rings.back().get(); mine->tid = (int)rings.size();
+  }
+  return *mine;
+}
+
+void profileRecord(ProfZone& z, uint64_t t0, uint64_t t1){
+  if(z.id<0) return;
+  z.frameNs.fetch_add(t1-t0, std::memory_order_relaxed);
+  if(!capturing.load(std::memory_order_relaxed)) return;
+  TraceRing& r = threadRing();
+  uint64_t n = r.written.load(std::memory_order_relaxed);
+  r.ev[n % PROF_RING_EVENTS] = TraceEvent{t0, t1, z.id};
+  r.written.store(n+1, std::memory_order_release);
+}
+
+void profileEnable(bool on){ PROF_ENABLED.store(on); }
+
+// ===== frame window (touched only by the thread calling profileFrameMark)
+static float    histMs[PROF_MAX_ZONES][PROF_WINDOW];
+static float    lastMs[PROF_MAX_ZONES];
+static int      histHead = 0, histCount = 0;
+static uint64_t lastMark = 0;
+
+void profileFrameMark(){
+  if(!PROF_ENABLED.load(std::memory_order_relaxed)){ lastMark = 0; return; }
+  uint64_t now = profileNowNs();
+  if(lastMark) profileRecord(FRAME_ZONE, lastMark, now);
+  lastMark = now;
+  int n = std::min(zoneCount.load(), PROF_MAX_ZONES);
+  for(int i=0;i<n;i++){
+    lastMs[i] = zones[i]->frameNs.exchange(0, std::memory_order_relaxed) * 1e-6f;
+    histMs[i][histHead] = lastMs[i];
+  }
+  histHead = (histHead+1) % PROF_WINDOW;
+  if(histCount<PROF_WINDOW) histCount++;
+}
+
+int profileSummary(ProfRow* out, int maxRows){
+  int n = std::min(zoneCount.load(), PROF_MAX_ZONES), rows = 0;
+  float tmp[PROF_WINDOW];
+  auto pct = [&](int z, float p){
+    std::copy(histMs[z], histMs[z]+histCount, tmp);
+    int idx = std::min(histCount-1, (int)(p*histCount));
+    std::nth_element(tmp, tmp+idx, tmp+histCount); return tmp[idx];
+  };
+  auto emit = [&](int z){
+    ProfRow& row = out[rows++];
+    row.name = zones[z]->name; row.lastMs = lastMs[z];
+    row.p50Ms = histCount ? pct(z, 0.50f) : 0.0f;
+    row.p99Ms = histCount ? pct(z, 0.99f) : 0.0f;
+  };
+  if(rows<maxRows && FRAME_ZONE.id>=0) emit(FRAME_ZONE.id);
+  for(int z=0; z<n && rows<maxRows; z++) if(z!=FRAME_ZONE.id) emit(z);
+  return rows;
+}
+
+void profileFrameHistogram(int* bins, int nbins, float maxMs){
+  std::fill(bins, bins+nbins, 0);
+  for(int i=0;i<histCount;i++){
+    int b = (int)(histMs[FRAME_ZONE.id][i] / maxMs * nbins);
+    bins[std::min(std::max(b,0), nbins-1)]++;
+  }
+}
+
+// ===== Chrome trace export
+void profileCapture(bool on){ capturing.store(on); }
+bool profileCapturing(){ return capturing.load(); }
+
+bool profileWriteTrace(const char* path){
+  capturing.store(false);
+  std::FILE* f = std::fopen(path, "w"); if(!f) return false;
+  std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  bool first = true;
+  std::lock_guard<std::mutex> lk(ringMutex);
+  for(const auto& r : rings){
+    uint64_t n = r->written.load(std::memory_order_acquire);
+    uint64_t from = n>(uint64_t)PROF_RING_EVENTS ? n-PROF_RING_EVENTS : 0;
+    for(uint64_t k=from;k<n;k++){
+      const TraceEvent& e = r->ev[k % PROF_RING_EVENTS];
+      std::fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                   first ? "" : ",\n", zones[e.zone]->name, r->tid, e.t0*1e-3, (e.t1-e.t0)*1e-3);
+      first = false;
+    }
+    r->written.store(0, std::memory_order_relaxed);
+  }
+  std::fprintf(f, "\n]}\n");
+  return std::fclose(f)==0;
+}
+
+} // namespace pac
+
+
+// =============================
+// File: src/replay.cpp
+// =============================
+#include <cstring>
+#include "replay.hpp"
+#include "rewind.hpp"
+#include "maze.hpp"
+#include "powerups.hpp"
+#include "util.hpp"
+
+namespace pac {
+
+static constexpr std::size_t HEADER_BYTES = 16;
+
+// ===== recording
+bool InputRecorder::open(const char* path, uint64_t seed, int level){
+  close(nowTick);
+  f = std::fopen(path, "ab"); if(!f) return false;
+  uint8_t h[HEADER_BYTES] = {'P','A','C','R', REPLAY_VERSION, 0, (uint8_t)level, (uint8_t)(level>>8)};
+  for(int i=0;i<8;i++) h[8+i] = (uint8_t)(seed >> (8*i));
+  std::fwrite(h, 1, sizeof(h), f); std::fflush(f);
+  lastTick = nowTick = 0;
+  return true;
+}
+
+void InputRecorder::put(uint64_t tick, uint8_t code){
+  uint8_t b[11]; int k=0; uint64_t d = tick - lastTick;
+  do { b[k] = d & 0x7f; d >>= 7; if(d) b[k] |= 0x80; k++; } while(d);
+  b[k++] = code;
+  std::fwrite(b, 1, k, f);
+  std::fflush(f);   // human-rate events; keep the log intact if the game dies
+  lastTick = tick;
+}
+
+void InputRecorder::record(uint64_t tick, InputCode in){ if(f) put(tick, (uint8_t)in); }
+
+void InputRecorder::close(uint64_t finalTick){
+  if(!f) return;
+  put(finalTick < lastTick ? lastTick : finalTick, REC_END);
+  std::fclose(f); f = nullptr;
+}
+
+// Reads one record; false at the end of the buffer or on a malformed varint
+static bool nextRecord(const uint8_t*& p, const uint8_t* end, uint64_t& delta, uint8_t& code){
+  delta = 0;
+  for(int shift=0;; shift+=7){
+    if(p>=end || shift>63) return false;
+    uint8_t b = *p++; delta |= (uint64_t)(b & 0x7f) << shift;
+    if(!(b & 0x80)) break;
+  }
+  if(p>=end) return false;
+  code = *p++;
+  return true;
+}
+
+bool splitSessions(const uint8_t* p, std::size_t n, std::vector<ReplaySession>& out){
+  const uint8_t* end = p+n;
+  while(p<end){
+    if((std::size_t)(end-p) < HEADER_BYTES || std::memcmp(p,"PACR",4)!=0 || p[4]!=REPLAY_VERSION) return false;
+    ReplaySession s; s.seed = 0; s.level = p[6] | p[7]<<8;
+    for(int i=0;i<8;i++) s.seed |= (uint64_t)p[8+i] << (8*i);
+    p += HEADER_BYTES; s.rec = p;
+    uint64_t d; uint8_t code;
+    do { if(!nextRecord(p, end, d, code)) return false; } while(code!=REC_END);
+    s.len = (std::size_t)(p - s.rec);
+    out.push_back(s);
+  }
+  return true;
+}
+
+// ===== replay
+ReplayResult runReplay(const ReplaySession& s){
+  ReplayResult res;
+  // Same setup as the shell's main() before the first "Play"
+  if(s.level>=levelCount()) return res;         // its pack is not loaded
+  World w; seedRng(w, s.seed); w.level = (uint16_t)s.level;
+  copyMazeFromTemplate(w); resetSupers(w); resetHeart(w);
+  RewindBuffer history;
+
+  const uint8_t *p = s.rec, *end = s.rec + s.len;
+  uint64_t tick = 0, target = 0; bool playing = false;
+  uint64_t d; uint8_t code;
+  while(nextRecord(p, end, d, code)){
+    target += d;
+    // The shell only steps while a game is on screen (not in menus)
+    while(playing && tick<target){
+      step(w, SIM_DT); tick++; history.onStep(w, tick);
+      if(finishGameOverHold(w)) playing = false;
+    }
+    if(tick!=target) break;                     // log ticks out of sync
+    if(code==REC_END){ res.ok = true; break; }
+    if(code>=IN_COUNT) break;
+    if(code==IN_NEW_GAME){ playing = true; res.games++; }
+    applyInput(w, history, (InputCode)code);
+  }
+  res.ticks = tick; res.score = w.rt.score; res.lives = w.rt.lives;
+  res.digest = worldDigest(w);
+  return res;
+}
+
+uint64_t worldDigest(const World& w){
+  uint64_t h = 1469598103934665603ULL;
+  auto mix = [&](const void* p, std::size_t n){
+    const uint8_t* b = (const uint8_t*)p;
+    for(std::size_t i=0;i<n;i++){ h ^= b[i]; h *= 1099511628211ULL; }
+  };
+  const Runtime& rt = w.rt;
+  int ints[] = { rt.pelletsTotal, rt.pelletsEaten, rt.score, rt.lives, rt.paused, rt.gameOver, rt.winGame, rt.deathActive };
+  float times[] = { rt.simTime, rt.pacAngleDeg };
+  mix(ints, sizeof(ints)); mix(times, sizeof(times));
+  mix(w.pellets.w, sizeof(w.pellets.w));
+  mix(&w.level, sizeof(w.level));
+  mix(&w.pacman, sizeof(Actor)); mix(w.ghosts, sizeof(w.ghosts));
+  mix(w.gDx, sizeof(w.gDx)); mix(w.gDy, sizeof(w.gDy));
+  for(const SuperFood& sf : w.supers){ int v[3]={sf.active,sf.r,sf.c}; mix(v,sizeof(v)); }
+  int hv[3]={w.heart.active,w.heart.r,w.heart.c}; mix(hv,sizeof(hv));
+  mix(&w.rng, sizeof(w.rng));
+  return h;
+}
+
+} // namespace pac
+
+
+// =============================
+// File: src/mapfile.cpp
+// =============================
+#include <cstdio>
+#include "mapfile.hpp"
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PAC_HAVE_MMAP 1
+#endif
+
+namespace pac {
+
+MappedFile::~MappedFile(){
+#ifdef PAC_HAVE_MMAP
+  if(mapped) munmap((void*)mapped, n);
+#endif
+}
+
+bool MappedFile::open(const char* path, bool useMmap, bool sequential){
+#ifdef PAC_HAVE_MMAP
+  if(useMmap){
+    int fd = ::open(path, O_RDONLY); if(fd<0) return false;
+    struct stat st; if(fstat(fd,&st)!=0 || st.st_size==0){ ::close(fd); return false; }
+    void* p = mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(p==MAP_FAILED) return false;
+    madvise(p, (std::size_t)st.st_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    mapped = (const uint8_t*)p; n = (std::size_t)st.st_size;
+    return true;
+  }
+#else
+  (void)useMmap; (void)sequential;
+#endif
+  std::FILE* fp = std::fopen(path, "rb"); if(!fp) return false;
+  std::fseek(fp, 0, SEEK_END); long sz = std::ftell(fp); std::fseek(fp, 0, SEEK_SET);
+  if(sz<=0){ std::fclose(fp); return false; }
+  buf.resize((std::size_t)sz); n = std::fread(buf.data(), 1, buf.size(), fp);
+  std::fclose(fp);
+  return n==buf.size();
+}
+
+} // namespace pac
+
+
+// =============================
+// File: src/rewind.cpp
+// =============================
+#include "rewind.hpp"
+
+namespace pac {
+
+bool RewindBuffer::rewind(World& w, int back){
+  if(count==0) return false;
+  if(back<1) back=1;
+  if(back>count) back=count;
+  head = (head - back + REWIND_SLOTS) % REWIND_SLOTS;
+  w = slots[head];
+  // Keep the restored snapshot so the next rewind continues further back
+  count -= back-1; head = (head+1) % REWIND_SLOTS;
+  return true;
+}
+
+void applyInput(World& w, RewindBuffer& history, InputCode in){
+  if(in==IN_REWIND){ history.rewind(w, (int)(REWIND_JUMP_S/(SIM_DT*REWIND_EVERY_TICKS) + 0.5f)); return; }
+  applyInput(w, in);
+  if(in==IN_NEW_GAME) history.clear();
+}
+
+} // namespace pac
+
+
+// =============================
+// File: src/vecenv.cpp
+// =============================
+#include <algorithm>
+#include <cstring>
+#include "vecenv.hpp"
+#include "logic.hpp"
+#include "maze.hpp"
+#include "util.hpp"
+
+namespace pac {
+
+static void writePlane(const BitBoard& b, float* out){
+  for(int i=0;i<BOARD_CELLS;i++) out[i] = (float)((b.w[i>>6]>>(i&63)) & 1u);
+}
+
+static void markCell(float* plane, int r, int c){
+  if(r>=0 && r<ROWS && c>=0 && c<COLS) plane[r*COLS+c] = 1.0f;
+}
+
+void writeObservation(const World& w, float* obs){
+  writePlane(levelOf(w).planes().pacBlocked, obs + OBS_WALLS*BOARD_CELLS);
+  writePlane(w.pellets, obs + OBS_PELLETS*BOARD_CELLS);
+  std::memset(obs + OBS_PACMAN*BOARD_CELLS, 0, (OBS_PLANES-OBS_PACMAN)*BOARD_CELLS*sizeof(float));
+  markCell(obs + OBS_PACMAN*BOARD_CELLS, yToRow(w.pacman.y), xToCol(w.pacman.x));
+  for(const Actor& g : w.ghosts) markCell(obs + OBS_GHOSTS*BOARD_CELLS, yToRow(g.y), xToCol(g.x));
+  for(const SuperFood& s : w.supers) if(s.active) markCell(obs + OBS_SUPERS*BOARD_CELLS, s.r, s.c);
+  if(w.heart.active) markCell(obs + OBS_HEART*BOARD_CELLS, w.heart.r, w.heart.c);
+}
+
+VecEnv::VecEnv(std::size_t n, int threads, int ticksPerStep, int maxSteps, bool swept)
+  : runner(threads), worlds(n), episodes(n,0), steps(n,0),
+    ticksPerStep(std::max(1,ticksPerStep)), maxSteps(std::max(0,maxSteps)), swept(swept) {}
+
+// Episode k of env i: its own seed and PCG stream, whatever thread runs it
+void VecEnv::startEpisode(std::size_t i){
+  World& w = worlds[i];
+  seedRng(w, seed+i, episodes[i]++);
+  startNewGame(w);
+  steps[i] = 0;
+}
+
+// A few chunks per thread so uneven episodes still balance; the per-env work
+// (a few ticks plus ~10 KB of observation) dwarfs the scheduling cost
+std::size_t VecEnv::chunk() const {
+  std::size_t c = worlds.size()/((std::size_t)runner.threadCount()*8);
+  return std::clamp<std::size_t>(c, 1, BATCH_CHUNK);
+}
+
+struct VecEnv::Job { VecEnv* env; const uint8_t* actions; float* obs; float* reward; uint8_t* done; };
+
+void VecEnv::resetChunk(void* ctx, std::size_t b, std::size_t e){
+  Job& job = *static_cast<Job*>(ctx); VecEnv& env = *job.env;
+  for(std::size_t i=b;i<e;i++){ env.startEpisode(i); writeObservation(env.worlds[i], job.obs + i*OBS_SIZE); }
+}
+
+void VecEnv::reset(uint64_t s, float* obs){
+  seed = s;
+  std::fill(episodes.begin(), episodes.end(), 0u);
+  Job job{this, nullptr, obs, nullptr, nullptr};
+  runner.parallelFor(worlds.size(), chunk(), resetChunk, &job);
+}
+
+void VecEnv::stepChunk(void* ctx, std::size_t b, std::size_t e){
+  Job& job = *static_cast<Job*>(ctx); VecEnv& env = *job.env;
+  for(std::size_t i=b;i<e;i++){
+    World& w = env.worlds[i];
+    int score0 = w.rt.score;
+    if(job.actions[i] < ACT_NONE) applyInput(w, (InputCode)(IN_UP + job.actions[i]));
+    if(env.swept) pac::step(w, env.ticksPerStep*SIM_DT);
+    else for(int t=0;t<env.ticksPerStep && !w.rt.gameOver && !w.rt.winGame;t++) pac::step(w, SIM_DT);
+    env.steps[i]++;
+    bool over = w.rt.gameOver || w.rt.winGame || (env.maxSteps && (int)env.steps[i] >= env.maxSteps);
+    job.reward[i] = (float)(w.rt.score - score0);
+    job.done[i] = over;
+    if(over) env.startEpisode(i);
+    writeObservation(w, job.obs + i*OBS_SIZE);
+  }
+}
+
+void VecEnv::step(const uint8_t* actions, float* obs, float* reward, uint8_t* done){
+  Job job{this, actions, obs, reward, done};
+  runner.parallelFor(worlds.size(), chunk(), stepChunk, &job);
+}
+
+} // namespace pac
+
+
+// =============================
+// File: src/mcts.cpp
+// =============================
+#include <algorithm>
+#include <cmath>
+#include "mcts.hpp"
+#include "maze.hpp"
+#include "paths.hpp"
+#include "util.hpp"
+
+namespace pac {
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int   MCTS_MAX_NODES = 1<<14;   // per tree, allocated once
+static constexpr int   MCTS_MAX_DEPTH = 64;      // tree path cap, in cells
+static constexpr int   CELL_TICK_CAP  = 2*(int)(1.0f/(PAC_SPEED*SIM_DT));   // a cell takes ~29 ticks
+static constexpr float DEATH_PENALTY  = 500.0f;
+static constexpr float WIN_BONUS      = 1000.0f;
+static constexpr float PELLET_PULL    = 9.0f;    // under one pellet: only breaks ties between empty rollouts
+
+// Arrow input per DIR_DX/DIR_DY index (right, left, up, down); k^1 reverses k
+static constexpr InputCode DIR_INPUT[4] = {IN_RIGHT, IN_LEFT, IN_UP, IN_DOWN};
+
+static bool ended(const World& w, int lives0){ return w.rt.deathActive || w.rt.gameOver || w.rt.winGame || w.rt.lives<lives0; }
+
+static int openDirs(const World& w, uint8_t out[4]){
+  unsigned m=levelOf(w).hdr->nbrMask[yToRow(w.pacman.y)*COLS+xToCol(w.pacman.x)]; int n=0;
+  for(int k=0;k<4;k++) if(m>>k & 1u) out[n++]=(uint8_t)k;
+  return n;
 }
-bool blockedForGhostCell(int r,int c){
-  return (r<0||r>=ROWS||c<0||c>=COLS||MAZE[r][c]==WALL);
+
+// Turn onto dir and step until Pac-Man reaches the next cell center, the
+// same tick poll() would decide again in the live game
+static void moveOneCell(World& w, int dir, int lives0){
+  applyInput(w, DIR_INPUT[dir]);
+  int r0=yToRow(w.pacman.y), c0=xToCol(w.pacman.x);
+  for(int t=0;t<CELL_TICK_CAP;t++){
+    step(w, SIM_DT);
+    if(ended(w, lives0)) return;
+    int r=yToRow(w.pacman.y), c=xToCol(w.pacman.x);
+    if((r!=r0 || c!=c0) && atCellCenter(w.pacman.x, w.pacman.y, r, c)) return;
+  }
 }
 
-float clampf(float v,float lo,float hi){ return v<lo?lo:(v>hi?hi:v); }
+// Score gained, a life costs DEATH_PENALTY; otherwise a pull toward the
+// nearest pellet through the flow field, which is rooted at Pac-Man's cell
+static float evaluate(const World& w, const World& root){
+  float v=(float)(w.rt.score - root.rt.score);
+  if(w.rt.deathActive || w.rt.gameOver || w.rt.lives<root.rt.lives) return v - DEATH_PENALTY;
+  if(w.rt.winGame) return v + WIN_BONUS;
+  const FlowField flow=pacFlowField(w); if(flow.root<0) return v;
+  const PathTable& pt=levelOf(w).paths; int best=DIST_FAR;
+  for(int id=0;id<pt.nCells;id++){ int cell=pt.cellOf[id]; if(flow.dist[id]<best && w.pellets.test(cell/COLS, cell%COLS)) best=flow.dist[id]; }
+  return best==DIST_FAR ? v : v + PELLET_PULL/(1.0f+best);
+}
 
-float cellCenterX(int c){ return c + 0.5f; }
-float cellCenterY(int r){ return (ROWS-1-r) + 0.5f; }
+MctsPlanner::MctsPlanner(const MctsConfig& cfg, int threads) : config(cfg), runner(threads), trees(runner.threadCount()) {
+  for(Tree& t : trees) t.nodes.resize(MCTS_MAX_NODES);
+}
 
-bool atCellCenter(float x,float y,int r,int c,float eps){
-  return std::fabs(x - cellCenterX(c)) < eps && std::fabs(y - cellCenterY(r)) < eps;
+void MctsPlanner::search(Tree& t, const World& root, Clock::time_point deadline, int iterCap){
+  t.used=1; t.nodes[0]=Node{}; t.iterations=0; t.depth=0; t.qMin=t.qMax=0.0f;
+  int path[MCTS_MAX_DEPTH]; World sim; const int lives0=root.rt.lives;
+  auto select=[&](int parent){
+    const Node& p=t.nodes[parent]; float span=t.qMax-t.qMin, logN=std::log((float)p.visits+1.0f);
+    int best=p.firstChild; float bestU=-1e30f;
+    for(int i=0;i<p.nChildren;i++){
+      const Node& ch=t.nodes[p.firstChild+i];
+      if(!ch.visits) return p.firstChild+i;   // every move once before comparing
+      float q = span>0.0f ? (ch.value/ch.visits - t.qMin)/span : 0.5f;
+      float u = q + config.explore*std::sqrt(logN/ch.visits);
+      if(u>bestU){ bestU=u; best=p.firstChild+i; }
+    }
+    return best;
+  };
+  while((iterCap<=0 || t.iterations<iterCap) && (config.budgetMs<=0.0f || Clock::now()<deadline)){
+    sim=root; int node=0, n=0; path[n++]=0; bool over=false;
+    // Selection down the tree, replaying each edge on the clone
+    while(t.nodes[node].nChildren && n<MCTS_MAX_DEPTH && !over){
+      node=select(node); moveOneCell(sim, t.nodes[node].dir, lives0);
+      over=ended(sim, lives0); path[n++]=node;
+    }
+    // Expansion: all open directions at once, then one of them at random
+    uint8_t dirs[4];
+    if(!over && n<MCTS_MAX_DEPTH){
+      int k=openDirs(sim, dirs);
+      if(k>0 && t.used+k<=(int)t.nodes.size()){
+        Node& p=t.nodes[node]; p.firstChild=t.used; p.nChildren=(uint8_t)k;
+        for(int i=0;i<k;i++){ t.nodes[t.used+i]=Node{}; t.nodes[t.used+i].dir=dirs[i]; }
+        t.used+=k;
+        node=p.firstChild+(int)pcgBelow(t.rng,(uint32_t)k); moveOneCell(sim, t.nodes[node].dir, lives0);
+        over=ended(sim, lives0); path[n++]=node;
+      }
+    }
+    // Rollout: random walk that only reverses in dead ends
+    int heading = n>1 ? t.nodes[node].dir : -1;
+    for(int cell=0; cell<config.rolloutCells && !over; cell++){
+      int k=openDirs(sim, dirs), m=0; if(!k) break;
+      for(int i=0;i<k;i++) if(dirs[i]!=(heading^1) || k==1) dirs[m++]=dirs[i];
+      heading=dirs[pcgBelow(t.rng,(uint32_t)m)];
+      moveOneCell(sim, heading, lives0); over=ended(sim, lives0);
+    }
+    float v=evaluate(sim, root);
+    if(t.iterations==0) t.qMin=t.qMax=v; else { t.qMin=std::min(t.qMin,v); t.qMax=std::max(t.qMax,v); }
+    for(int i=0;i<n;i++){ Node& nd=t.nodes[path[i]]; nd.visits++; nd.value+=v; }
+    t.depth=std::max(t.depth, n-1); t.iterations++;
+  }
+}
+
+struct MctsPlanner::Job { MctsPlanner* self; const World* root; Clock::time_point deadline; int iterCap; };
+
+void MctsPlanner::searchChunk(void* ctx, std::size_t b, std::size_t e){
+  Job& job=*static_cast<Job*>(ctx);
+  for(std::size_t i=b;i<e;i++) job.self->search(job.self->trees[i], *job.root, job.deadline, job.iterCap);
+}
+
+int MctsPlanner::decide(const World& w, uint64_t salt){
+  auto t0=Clock::now(); stats=MctsStats{};
+  uint8_t dirs[4]; int k=openDirs(w, dirs);
+  if(k<=1) return k ? dirs[0] : DIR_NONE;
+  int iterCap = config.maxIterations>0 ? config.maxIterations : (config.budgetMs>0.0f ? 0 : 256);
+  for(std::size_t i=0;i<trees.size();i++) pcgSeed(trees[i].rng, salt, i);
+  Job job{this, &w, t0+std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float,std::milli>(config.budgetMs)), iterCap};
+  runner.parallelFor(trees.size(), 1, searchChunk, &job);
+
+  // Merge the roots: most visits wins, mean value breaks ties
+  int visits[4]={0}; float value[4]={0};
+  for(const Tree& t : trees){
+    const Node& r=t.nodes[0];
+    for(int i=0;i<r.nChildren;i++){ const Node& ch=t.nodes[r.firstChild+i]; visits[ch.dir]+=ch.visits; value[ch.dir]+=ch.value; }
+    stats.iterations+=t.iterations; stats.depth=std::max(stats.depth, t.depth);
+  }
+  int best=dirs[0];
+  for(int i=1;i<k;i++){
+    int d=dirs[i];
+    if(visits[d]>visits[best] || (visits[d]==visits[best] && visits[d] && value[d]/visits[d] > value[best]/visits[best])) best=d;
+  }
+  stats.ms=std::chrono::duration<double,std::milli>(Clock::now()-t0).count();
+  return best;
+}
+
+InputCode MctsPlanner::poll(const World& w, uint64_t salt, Clock::time_point endBy){
+  const Runtime& rt=w.rt; const Actor& p=w.pacman;
+  if(rt.paused || rt.deathActive || rt.gameOver || rt.winGame) return IN_COUNT;
+  int r=yToRow(p.y), c=xToCol(p.x);
+  if(!atCellCenter(p.x, p.y, r, c)){
+    // Pressed into a wall between centers (an arrow key mid-cell): back out
+    bool stuck = p.x==lastX && p.y==lastY && (p.vx!=0.0f || p.vy!=0.0f);
+    lastX=p.x; lastY=p.y;
+    if(!stuck) return IN_COUNT;
+    lastCell=-1;
+    return p.vx>0.0f ? IN_LEFT : p.vx<0.0f ? IN_RIGHT : p.vy>0.0f ? IN_DOWN : IN_UP;
+  }
+  bool stopped = p.vx==0.0f && p.vy==0.0f;
+  if(r*COLS+c==lastCell && !stopped) return IN_COUNT;
+  if(Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float,std::milli>(config.budgetMs)) > endBy) return IN_COUNT;
+  lastCell=r*COLS+c;
+  int d=decide(w, salt);
+  if(d==DIR_NONE || (p.vx==DIR_DX[d] && p.vy==DIR_DY[d])) return IN_COUNT;
+  return DIR_INPUT[d];
 }
 
 } // namespace pac
 
 
 // =============================
-// File: src/powerups.cpp
+// File: src/bigmaze.cpp
 // =============================
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include "bigmaze.hpp"
+#include "bitboard.hpp"
+#include "config.hpp"
+
+namespace pac {
+
+static inline uint64_t mix64(uint64_t x){
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x>>30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x>>27)) * 0x94d049bb133111ebULL;
+  return x ^ (x>>31);
+}
+
+// Chance (out of 256) that a room opens both ways, which is what makes loops
+static constexpr unsigned LOOP_CHANCE = 64;
+
+// Rooms sit at odd (r,c). Each opens north or west towards room (1,1), so
+// every room is reachable; some open both ways.
+static bool roomOpens(uint64_t seed, int r, int c, bool north){
+  if(r==1 && c==1) return false;
+  if(r==1) return !north;
+  if(c==1) return north;
+  uint64_t h = mix64(seed ^ ((uint64_t)r<<32 | (uint32_t)c));
+  if((h>>8 & 0xff) < LOOP_CHANCE) return true;
+  return (h&1) ? north : !north;
+}
+
+static bool cellOpen(uint64_t seed, int rows, int cols, int r, int c){
+  bool oddR = r&1, oddC = c&1;
+  if(r<1 || c<1 || r>rows-2 || c>cols-2) return false;
+  if(oddR && oddC) return true;                                               // room
+  if(oddR) return c+1<=cols-2 && roomOpens(seed, r, c+1, false);              // passage west of room (r,c+1)
+  if(oddC) return r+1<=rows-2 && roomOpens(seed, r+1, c, true);               // passage north of room (r+1,c)
+  return false;
+}
+
+void ChunkedMaze::generate(int rows, int cols, uint64_t seed){
+  nRows = std::clamp(rows, 3, BIG_MAX_SIDE); nCols = std::clamp(cols, 3, BIG_MAX_SIDE);
+  nChunkRows = (nRows+CHUNK-1)/CHUNK; nChunkCols = (nCols+CHUNK-1)/CHUNK;
+  chunks.assign((std::size_t)nChunkRows*nChunkCols, MazeChunk{});
+  pellets = 0;
+  for(int cr=0; cr<nChunkRows; cr++) for(int cc=0; cc<nChunkCols; cc++){
+    MazeChunk& k = chunks[(std::size_t)cr*nChunkCols+cc];
+    for(int lr=0; lr<CHUNK; lr++){
+      uint64_t walls=~0ull, open=0;
+      int r=cr*CHUNK+lr;
+      for(int lc=0; lc<CHUNK; lc++){
+        int c=cc*CHUNK+lc;
+        if(r<nRows && c<nCols && cellOpen(seed, nRows, nCols, r, c)){ walls &= ~(1ull<<lc); open |= 1ull<<lc; }
+      }
+      k.walls[lr]=walls; k.pellets[lr]=open; k.pelletCount += popcount64(open);
+    }
+    pellets += k.pelletCount;
+  }
+}
+
+bool ChunkedMaze::eat(int r,int c){
+  if(!pellet(r,c)) return false;
+  MazeChunk& k = chunks[(std::size_t)(r/CHUNK)*nChunkCols + c/CHUNK];
+  k.pellets[r%CHUNK] &= ~(1ull<<(c%CHUNK));
+  k.pelletCount--; k.version++; pellets--;
+  return true;
+}
+
+// ===== simulation
+
+static constexpr int DX4[4]={1,-1,0,0}, DY4[4]={0,0,-1,1};   // right, left, up, down (rows grow down)
+
+// Move a by dist cells; every center it reaches asks choose(a) for a heading
+// (which may stop it)
+template<class Choose> static void advance(BigActor& a, float dist, Choose&& choose){
+  if(!a.dx && !a.dy){ choose(a); if(!a.dx && !a.dy) return; }
+  a.t += dist;
+  while(a.t>=1.0f){
+    a.t -= 1.0f; a.r += a.dy; a.c += a.dx;
+    choose(a);
+    if(!a.dx && !a.dy){ a.t=0.0f; return; }
+  }
+}
+
+static int openDirs(const ChunkedMaze& m, const BigActor& a, int out[4]){
+  int n=0;
+  for(int k=0;k<4;k++) if(!m.wall(a.r+DY4[k], a.c+DX4[k])) out[n++]=k;
+  return n;
+}
+
+// Never reverses unless it is the only way
+static int forwardDirs(const ChunkedMaze& m, const BigActor& a, int out[4]){
+  int all[4], n=openDirs(m, a, all), k=0;
+  for(int i=0;i<n;i++) if(!(DX4[all[i]]==-a.dx && DY4[all[i]]==-a.dy) || n==1) out[k++]=all[i];
+  return k;
+}
+
+void BigSim::chooseForPac(BigActor& a){
+  if(m.eat(a.r, a.c)) score += 10;
+  if(!autopilot){
+    if((wantDx || wantDy) && !m.wall(a.r+wantDy, a.c+wantDx)){ a.dx=wantDx; a.dy=wantDy; return; }
+    if(m.wall(a.r+a.dy, a.c+a.dx)){ a.dx=a.dy=0; }
+    return;
+  }
+  int d[4], n=forwardDirs(m, a, d);
+  if(!n){ a.dx=a.dy=0; return; }
+  bool straight = (a.dx || a.dy) && !m.wall(a.r+a.dy, a.c+a.dx);
+  if(straight && pcgBelow(rng,4)) return;
+  int k=d[pcgBelow(rng,(uint32_t)n)]; a.dx=DX4[k]; a.dy=DY4[k];
+}
+
+// Mostly closes in on Pac-Man by Manhattan distance, sometimes wanders
+void BigSim::chooseForGhost(BigActor& a){
+  int d[4], n=forwardDirs(m, a, d);
+  if(!n){ a.dx=a.dy=0; return; }
+  int k=d[pcgBelow(rng,(uint32_t)n)];
+  if(pcgBelow(rng,4)){
+    int best=1<<30;
+    for(int i=0;i<n;i++){
+      int dist=std::abs(a.r+DY4[d[i]]-pac.r)+std::abs(a.c+DX4[d[i]]-pac.c);
+      if(dist<best){ best=dist; k=d[i]; }
+    }
+  }
+  a.dx=DX4[k]; a.dy=DY4[k];
+}
+
+void BigSim::reset(int rows, int cols, uint64_t seed){
+  m.generate(rows, cols, seed);
+  pcgSeed(rng, seed, 1);
+  pac=BigActor{}; score=catches=ticks=0; activeGhosts=0; autopilot=true; wantDx=wantDy=0;
+  m.eat(pac.r, pac.c);
+  std::size_t nChunks=(std::size_t)m.chunkRows()*m.chunkCols();
+  buckets.assign(nChunks, {});
+  ghosts.clear(); homes.clear(); ghostChunk.clear(); ghostSlot.clear();
+  for(std::size_t ch=0; ch<nChunks; ch++){
+    int cr=(int)(ch/m.chunkCols()), cc=(int)(ch%m.chunkCols());
+    for(int g=0; g<BIG_GHOSTS_PER_CHUNK; g++){
+      // Random room in the tile; tiles cut off by the maze edge may have none
+      for(int tries=0; tries<16; tries++){
+        BigActor a; a.r=(cr*CHUNK+(int)pcgBelow(rng,CHUNK))|1; a.c=(cc*CHUNK+(int)pcgBelow(rng,CHUNK))|1;
+        if(m.wall(a.r,a.c) || (std::abs(a.r-pac.r)<8 && std::abs(a.c-pac.c)<8)) continue;
+        uint32_t id=(uint32_t)ghosts.size();
+        ghosts.push_back(a); homes.push_back(a);
+        ghostChunk.push_back((uint32_t)ch); ghostSlot.push_back((uint32_t)buckets[ch].size());
+        buckets[ch].push_back(id);
+        break;
+      }
+    }
+  }
+  scratch.reserve((std::size_t)(2*BIG_ACTIVE_RADIUS+1)*(2*BIG_ACTIVE_RADIUS+1)*BIG_GHOSTS_PER_CHUNK*4);
+}
+
+// Keep ghost i in the bucket of the chunk it stands in (swap-remove + push)
+void BigSim::rebucket(uint32_t i){
+  const BigActor& a=ghosts[i];
+  uint32_t ch=(uint32_t)((a.r/CHUNK)*m.chunkCols() + a.c/CHUNK);
+  if(ch==ghostChunk[i]) return;
+  std::vector<uint32_t>& from=buckets[ghostChunk[i]];
+  uint32_t moved=from.back(); from[ghostSlot[i]]=moved; ghostSlot[moved]=ghostSlot[i]; from.pop_back();
+  ghostChunk[i]=ch; ghostSlot[i]=(uint32_t)buckets[ch].size(); buckets[ch].push_back(i);
+}
+
+void BigSim::step(float dt){
+  ticks++;
+  advance(pac, PAC_SPEED*dt, [&](BigActor& a){ chooseForPac(a); });
+
+  // Wake only the chunks around Pac-Man
+  int pcr=pac.r/CHUNK, pcc=pac.c/CHUNK;
+  scratch.clear();
+  for(int cr=std::max(0,pcr-BIG_ACTIVE_RADIUS); cr<=std::min(m.chunkRows()-1,pcr+BIG_ACTIVE_RADIUS); cr++)
+    for(int cc=std::max(0,pcc-BIG_ACTIVE_RADIUS); cc<=std::min(m.chunkCols()-1,pcc+BIG_ACTIVE_RADIUS); cc++){
+      const std::vector<uint32_t>& b=ghostsIn(cr,cc); scratch.insert(scratch.end(), b.begin(), b.end());
+    }
+  activeGhosts=(int)scratch.size();
+
+  float px=pac.c+pac.dx*pac.t, py=pac.r+pac.dy*pac.t;
+  for(uint32_t i : scratch){
+    BigActor& g=ghosts[i];
+    advance(g, GHOST_SPEED0*dt, [&](BigActor& a){ chooseForGhost(a); });
+    float gx=g.c+g.dx*g.t, gy=g.r+g.dy*g.t;
+    // A catch sends the ghost home; the soak run keeps going
+    if((gx-px)*(gx-px)+(gy-py)*(gy-py) < 0.36f){ catches++; g=homes[i]; }
+    rebucket(i);
+  }
+}
+
+} // namespace pac
+
+
+// =============================
+// File: src/powerups.cpp
+// =============================
 #include <cmath>
 #include "powerups.hpp"
 #include "maze.hpp"
 #include "util.hpp"
+#include "profile.hpp"
 
 namespace pac {
 
-SuperFood supers[MAX_SUPERS];
-Heart     heart{false,0,0};
-
-static bool isValidSpawnCellCommon(int r,int c, const Actor& pac, const Actor ghosts[4]){
-  if(r<0||r>=ROWS||c<0||c>=COLS) return false;
-  if(MAZE[r][c]==WALL || MAZE[r][c]==GATE) return false;
-  int rp=yToRow(pac.y), cp=xToCol(pac.x);
+// Walls and the gate are already excluded by the level's spawn list; this
+// only rules out cells an actor stands on
+static bool isValidSpawnCellCommon(const World& w,int r,int c){
+  int rp=yToRow(w.pacman.y), cp=xToCol(w.pacman.x);
   if(r==rp && c==cp) return false;
   for(int i=0;i<4;i++){
-    int rg=yToRow(ghosts[i].y), cg=xToCol(ghosts[i].x);
+    int rg=yToRow(w.ghosts[i].y), cg=xToCol(w.ghosts[i].x);
     if(r==rg && c==cg) return false;
   }
   return true;
 }
 
-void resetSupers(Runtime& rt){
-  for(int i=0;i<MAX_SUPERS;i++) supers[i] = {false,0,0};
-  rt.lastSuperSpawnAt = 0.0f;
+void resetSupers(World& w){
+  for(int i=0;i<MAX_SUPERS;i++) w.supers[i] = {false,0,0};
+  w.rt.lastSuperSpawnAt = 0.0f;
 }
-void resetHeart(Runtime& rt){
-  heart = {false,0,0};
-  rt.lastHeartSpawnAt = 0.0f;
+void resetHeart(World& w){
+  w.heart = {false,0,0};
+  w.rt.lastHeartSpawnAt = 0.0f;
 }
 
-static int countActiveSupersImpl(){
-  int n=0; for(int i=0;i<MAX_SUPERS;i++) if(supers[i].active) n++; return n;
+static int countActiveSupersImpl(const World& w){
+  int n=0; for(int i=0;i<MAX_SUPERS;i++) if(w.supers[i].active) n++; return n;
+}
+int activeSuperCount(const World& w){ return countActiveSupersImpl(w); }
+
+// One draw from the precomputed open cells of w's level, so no try is spent on a wall
+static bool randomSpawnCell(World& w,int& r,int& c){
+  const LevelHeader& lv = *levelOf(w).hdr;
+  if(lv.spawnCount<=0) return false;
+  int cell = lv.spawnCells[randBelow(w,lv.spawnCount)];
+  r = cell/COLS; c = cell%COLS;
+  return isValidSpawnCellCommon(w,r,c);
 }
-int activeSuperCount(){ return countActiveSupersImpl(); }
 
-static void spawnOneSuper(const Actor& pac, const Actor ghosts[4]){
+static void spawnOneSuper(World& w){
   for(int tries=0; tries<200; ++tries){
-    int r = std::rand()%ROWS; int c = std::rand()%COLS;
-    if(!isValidSpawnCellCommon(r,c,pac,ghosts)) continue;
+    int r,c;
+    if(!randomSpawnCell(w,r,c)) continue;
     // avoid heart & existing supers overlap
     bool conflict=false;
-    for(int i=0;i<MAX_SUPERS;i++) if(supers[i].active && supers[i].r==r && supers[i].c==c) {conflict=true;break;}
-    if(heart.active && heart.r==r && heart.c==c) conflict=true;
+    for(int i=0;i<MAX_SUPERS;i++) if(w.supers[i].active && w.supers[i].r==r && w.supers[i].c==c) {conflict=true;break;}
+    if(w.heart.active && w.heart.r==r && w.heart.c==c) conflict=true;
     if(conflict) continue;
-    for(int i=0;i<MAX_SUPERS;i++) if(!supers[i].active){ supers[i] = {true,r,c}; return; }
+    for(int i=0;i<MAX_SUPERS;i++) if(!w.supers[i].active){ w.supers[i] = {true,r,c}; return; }
     return;
   }
 }
 
-void maybeSpawnSupers(Runtime& rt, float elapsed){
-  if(elapsed - rt.lastSuperSpawnAt >= SUPER_SPAWN_INTERVAL){
-    rt.lastSuperSpawnAt = elapsed;
-    if(countActiveSupersImpl() < MAX_SUPERS){
-      extern Actor ghosts[4]; extern Actor pacman; // from logic.cpp
-      spawnOneSuper(pacman, ghosts);
-    }
+void maybeSpawnSupers(World& w, float elapsed){
+  PAC_PROFILE_SCOPE("spawnSupers");
+  if(elapsed - w.rt.lastSuperSpawnAt >= SUPER_SPAWN_INTERVAL){
+    w.rt.lastSuperSpawnAt = elapsed;
+    if(countActiveSupersImpl(w) < MAX_SUPERS) spawnOneSuper(w);
   }
 }
 
-static void spawnHeartImpl(const Actor& pac, const Actor ghosts[4]){
+static void spawnHeartImpl(World& w){
   for(int tries=0; tries<200; ++tries){
-    int r = std::rand()%ROWS; int c = std::rand()%COLS;
-    if(!isValidSpawnCellCommon(r,c,pac,ghosts)) continue;
+    int r,c;
+    if(!randomSpawnCell(w,r,c)) continue;
     // avoid supers overlap
     bool conflict=false;
-    for(int i=0;i<MAX_SUPERS;i++) if(supers[i].active && supers[i].r==r && supers[i].c==c) {conflict=true;break;}
+    for(int i=0;i<MAX_SUPERS;i++) if(w.supers[i].active && w.supers[i].r==r && w.supers[i].c==c) {conflict=true;break;}
     if(conflict) continue;
-    heart = {true,r,c};
+    w.heart = {true,r,c};
     return;
   }
 }
 
-void maybeSpawnHeart(Runtime& rt, float elapsed){
-  if(heart.active) return;
-  if(elapsed - rt.lastHeartSpawnAt >= HEART_SPAWN_INTERVAL){
-    rt.lastHeartSpawnAt = elapsed;
-    extern Actor ghosts[4]; extern Actor pacman; // from logic.cpp
-    spawnHeartImpl(pacman, ghosts);
+void maybeSpawnHeart(World& w, float elapsed){
+  PAC_PROFILE_SCOPE("spawnHeart");
+  if(w.heart.active) return;
+  if(elapsed - w.rt.lastHeartSpawnAt >= HEART_SPAWN_INTERVAL){
+    w.rt.lastHeartSpawnAt = elapsed;
+    spawnHeartImpl(w);
   }
 }
 
-void checkEatSuper(Runtime& rt, const Actor& pac){
+void checkEatSuper(World& w, float fromX, float fromY){
+  const Actor& pac = w.pacman;
   for(int i=0;i<MAX_SUPERS;i++){
-    if(!supers[i].active) continue;
-    float cx = cellCenterX(supers[i].c);
-    float cy = cellCenterY(supers[i].r);
-    float dx = pac.x - cx; float dy = pac.y - cy;
+    if(!w.supers[i].active) continue;
+    float cx = cellCenterX(w.supers[i].c);
+    float cy = cellCenterY(w.supers[i].r);
     float rr = (pac.radius + 0.30f);
-    if(dx*dx + dy*dy <= rr*rr){ supers[i].active=false; rt.score += 100; }
+    if(sweptDistSq(fromX, fromY, pac.x, pac.y, cx, cy) <= rr*rr){ w.supers[i].active=false; w.rt.score += 100; }
   }
 }
 
-void checkEatHeart(Runtime& rt, Actor& pac){
-  (void)pac; // not used now
-  if(!heart.active) return;
-  float cx = cellCenterX(heart.c);
-  float cy = cellCenterY(heart.r);
-  float dx = pacman.x - cx; float dy = pacman.y - cy;
-  float rr = (pacman.radius + 0.28f);
-  if(dx*dx + dy*dy <= rr*rr){
-    heart.active = false;
-    if(rt.lives < 3) rt.lives += 1;
+void checkEatHeart(World& w, float fromX, float fromY){
+  const Actor& pac = w.pacman;
+  if(!w.heart.active) return;
+  float cx = cellCenterX(w.heart.c);
+  float cy = cellCenterY(w.heart.r);
+  float rr = (pac.radius + 0.28f);
+  if(sweptDistSq(fromX, fromY, pac.x, pac.y, cx, cy) <= rr*rr){
+    w.heart.active = false;
+    if(w.rt.lives < 3) w.rt.lives += 1;
   }
 }
 
+void checkEatSuper(World& w){ checkEatSuper(w, w.pacman.x, w.pacman.y); }
+void checkEatHeart(World& w){ checkEatHeart(w, w.pacman.x, w.pacman.y); }
+
 } // namespace pac
 
 
 // =============================
 // File: src/logic.cpp
 // =============================
-#include <cstdlib>
 #include <cmath>
 #include <algorithm>
 #include "logic.hpp"
+#include "events.hpp"
 #include "maze.hpp"
 #include "util.hpp"
 #include "powerups.hpp"
+#include "paths.hpp"
+#include "profile.hpp"
 
 namespace pac {
 
-Actor pacman {9.5f,15.5f,0,0,0.33f};
-Actor ghosts[4] = {
-  {9.5f,10.5f,0,0,0.33f},
-  {7.5f,10.5f,0,0,0.33f},
-  {11.5f,10.5f,0,0,0.33f},
-  {9.5f, 9.5f,0,0,0.33f}
-};
-
-int gDx[4]={0}, gDy[4]={0};
+static inline float nowSeconds(const Runtime& rt){ return rt.simTime; }
 
-static inline float nowSeconds(const Runtime& rt){
-  using Clock = std::chrono::steady_clock;
-  return std::chrono::duration<float>(Clock::now() - rt.tStart).count();
+void resetActors(World& w){
+  w.pacman = {9.5f,15.5f,0,0,0.33f};
+  w.ghosts[0] = {9.5f,10.5f,0,0,0.33f};
+  w.ghosts[1] = {7.5f,10.5f,0,0,0.33f};
+  w.ghosts[2] = {11.5f,10.5f,0,0,0.33f};
+  w.ghosts[3] = {9.5f, 9.5f,0,0,0.33f};
+  w.rt.pacAngleDeg = 0.0f;
 }
 
-void resetActors(Runtime& rt){
-  pacman = {9.5f,15.5f,0,0,0.33f};
-  ghosts[0] = {9.5f,10.5f,0,0,0.33f};
-  ghosts[1] = {7.5f,10.5f,0,0,0.33f};
-  ghosts[2] = {11.5f,10.5f,0,0,0.33f};
-  ghosts[3] = {9.5f, 9.5f,0,0,0.33f};
-  rt.pacAngleDeg = 0.0f;
-}
-
-void initGhostDirsRandom(){
+void initGhostDirsRandom(World& w){
   for(int i=0;i<4;i++){
-    int d=std::rand()%4; int dx[4]={1,-1,0,0}; int dy[4]={0,0,1,-1};
-    gDx[i]=dx[d]; gDy[i]=dy[d];
+    int d=randBelow(w,4); int dx[4]={1,-1,0,0}; int dy[4]={0,0,1,-1};
+    w.gDx[i]=dx[d]; w.gDy[i]=dy[d];
   }
 }
 
-void eatPellet(Runtime& rt){
-  int r=yToRow(pacman.y), c=xToCol(pacman.x);
-  if(MAZE[r][c]==DOTCELL){ MAZE[r][c]=EMPTY; rt.pelletsEaten++; rt.score+=10; }
+static void eatPelletAt(World& w,int r,int c){
+  Runtime& rt = w.rt;
+  if(w.pellets.test(r,c)){ w.pellets.clear(r,c); rt.pelletsEaten++; rt.score+=10; }
   if(rt.pelletsEaten==rt.pelletsTotal){ rt.winGame=true; rt.paused=true; }
 }
 
-void triggerDeath(Runtime& rt){
+void eatPellet(World& w){ eatPelletAt(w, yToRow(w.pacman.y), xToCol(w.pacman.x)); }
+
+void triggerDeath(World& w){
+  Runtime& rt = w.rt;
   if(rt.deathActive || rt.gameOver || rt.winGame) return;
   rt.deathActive = true;
-  rt.tDeathStart = std::chrono::steady_clock::now();
-  pacman.vx = 0.0f; pacman.vy = 0.0f;
+  rt.tDeathStart = rt.simTime;
+  w.pacman.vx = 0.0f; w.pacman.vy = 0.0f;
 }
 
-void finalizeDeath(Runtime& rt){
+void finalizeDeath(World& w){
+  Runtime& rt = w.rt;
   rt.lives -= 1;
   if(rt.lives <= 0){
     rt.gameOver = true; rt.paused = true; rt.deathActive = false;
-    rt.tGameOverAt = std::chrono::steady_clock::now();
+    rt.tGameOverAt = rt.simTime;
     rt.postMenuShown = false;
     return;
   }
   // Reset for next life
-  resetActors(rt);
-  initGhostDirsRandom();
+  resetActors(w);
+  initGhostDirsRandom(w);
   rt.deathActive = false;
 }
 
@@ -490,74 +2860,199 @@ void worldToNextCell(int r,int c,int dx,int dy,int& nr,int& nc){
   nr=r; nc=c; if(dx>0) nc=c+1; if(dx<0) nc=c-1; if(dy>0) nr=r-1; if(dy<0) nr=r+1;
 }
 
-bool ghostCanGo(int r,int c,int dx,int dy){
-  int nr,nc; worldToNextCell(r,c,dx,dy,nr,nc); return !blockedForGhostCell(nr,nc);
+bool ghostCanGo(const World& w,int r,int c,int dx,int dy){
+  int nr,nc; worldToNextCell(r,c,dx,dy,nr,nc); return !blockedForGhostCell(w,nr,nc);
 }
 
-void chooseGhostDirWithChase(int i,int r,int c){
-  int curDx=gDx[i], curDy=gDy[i];
+FlowField pacFlowField(const World& w){
+  const PathTable& pt = levelOf(w).paths;
+  return flowField(pt, pt.idAt(yToRow(w.pacman.y), xToCol(w.pacman.x)));
+}
+
+// Shortest-path chase: step to the non-reversing neighbour with the smallest
+// distance in the flow field rooted at Pac-Man (ghosts still never U-turn).
+void chooseGhostDirWithChase(World& w,int i,int r,int c){
+  int curDx=w.gDx[i], curDy=w.gDy[i];
   struct D{int dx,dy;}; D dirs[4]={{1,0},{-1,0},{0,1},{0,-1}}; // right,left,up,down
-  float bestScore = 1e9f; int bestDx=0,bestDy=0;
-  for(auto d:dirs){
-    if(d.dx==-curDx && d.dy==-curDy) continue;
-    if(!ghostCanGo(r,c,d.dx,d.dy)) continue;
-    int nr,nc; worldToNextCell(r,c,d.dx,d.dy,nr,nc);
-    float nx=cellCenterX(nc), ny=cellCenterY(nr);
-    float score = std::fabs(nx - pacman.x) + std::fabs(ny - pacman.y) + (std::rand()%100)*0.001f;
-    if(score<bestScore){ bestScore=score; bestDx=d.dx; bestDy=d.dy; }
-  }
-  if(bestDx||bestDy){ gDx[i]=bestDx; gDy[i]=bestDy; return; }
-  for(auto d:dirs){ if(ghostCanGo(r,c,d.dx,d.dy)){ gDx[i]=d.dx; gDy[i]=d.dy; return; } }
-  gDx[i]=0; gDy[i]=0;
-}
-
-void updatePac(Runtime& rt, float dt){
-  float nx=pacman.x+pacman.vx*PAC_SPEED*dt, ny=pacman.y+pacman.vy*PAC_SPEED*dt;
-  if(!blockedForPac(yToRow(pacman.y),xToCol(nx))) pacman.x=clampf(nx,0.5f,COLS-0.5f);
-  if(!blockedForPac(yToRow(ny),xToCol(pacman.x))) pacman.y=clampf(ny,0.5f,ROWS-0.5f);
+  const PathTable& pt = levelOf(w).paths;
+  int from=pt.idAt(r,c);
+  const FlowField flow = pacFlowField(w);
+  if(from>=0 && flow.root>=0){
+    int best=DIST_FAR, bestD=-1;
+    for(int k=0;k<4;k++){
+      int v=pt.nbr[from*4+k];
+      if(v<0 || (DIR_DX[k]==-curDx && DIR_DY[k]==-curDy)) continue;
+      if(flow.dist[v]<best){ best=flow.dist[v]; bestD=k; }
+    }
+    if(bestD>=0){ w.gDx[i]=DIR_DX[bestD]; w.gDy[i]=DIR_DY[bestD]; return; }
+  }
+  for(auto d:dirs){ if(ghostCanGo(w,r,c,d.dx,d.dy)){ w.gDx[i]=d.dx; w.gDy[i]=d.dy; return; } }
+  w.gDx[i]=0; w.gDy[i]=0;
+}
+
+// Pac-Man's x (alongX) or y after moving d cells along that axis. He enters
+// the cells one at a time, eating each pellet on the way; a wall stops him
+// where SIM_DT steps would have, so a short move into one is refused as ever.
+static float sweepPacAxis(World& w, float d, bool alongX){
+  const Actor& p = w.pacman;
+  const float from = alongX ? p.x : p.y, to = from + d;
+  if(d==0.0f) return clampf(from, 0.5f, (alongX ? COLS : ROWS)-0.5f);
+  auto cellAt  = [&](float v){ return alongX ? xToCol(v) : yToRow(v); };
+  auto blocked = [&](int k){ return alongX ? blockedForPac(w, yToRow(p.y), k) : blockedForPac(w, k, xToCol(p.x)); };
+  const int k1 = cellAt(to), dk = k1 > cellAt(from) ? 1 : -1;
+  for(int k=cellAt(from); k!=k1; ){
+    k += dk;
+    if(blocked(k)){
+      const float s = d>0.0f ? 1.0f : -1.0f, h = std::min(std::fabs(d), PAC_SPEED*SIM_DT);
+      const float lo = alongX ? (float)k : (float)(ROWS-1-k), edge = s>0.0f ? lo : lo+1.0f;
+      int n = (int)((edge-from)*s/h);
+      if(n>0 && (cellAt(from + s*n*h) - k)*dk >= 0) n--;
+      return from + s*n*h;
+    }
+    eatPelletAt(w, alongX ? yToRow(p.y) : k, alongX ? k : xToCol(p.x));
+  }
+  return clampf(to, 0.5f, (alongX ? COLS : ROWS)-0.5f);
+}
+
+static void movePac(World& w, float dt){
+  Actor& pacman = w.pacman;
+  pacman.x = sweepPacAxis(w, pacman.vx*PAC_SPEED*dt, true);
+  pacman.y = sweepPacAxis(w, pacman.vy*PAC_SPEED*dt, false);
+}
+
+void updatePac(World& w, float dt){
+  PAC_PROFILE_SCOPE("updatePac");
+  Actor& pacman = w.pacman;
+  const float x0=pacman.x, y0=pacman.y;
+  movePac(w, dt);
   if(std::fabs(pacman.vx)>1e-4f || std::fabs(pacman.vy)>1e-4f){
-    rt.pacAngleDeg = std::atan2(pacman.vy, pacman.vx) * 180.0f / 3.14159265f;
+    w.rt.pacAngleDeg = std::atan2(pacman.vy, pacman.vx) * 180.0f / 3.14159265f;
   }
-  eatPellet(rt);
-  checkEatSuper(rt, pacman);
-  checkEatHeart(rt, pacman);
+  eatPellet(w);
+  checkEatSuper(w, x0, y0);
+  checkEatHeart(w, x0, y0);
 }
 
-void updateGhosts(Runtime& rt, float dt){
-  using Clock = std::chrono::steady_clock;
-  float elapsed=std::chrono::duration<float>(Clock::now()-rt.tStart).count();
+float ghostSpeed(float elapsed){
   float gs=GHOST_SPEED0+(int(elapsed)/STEP_EVERY_S)*GHOST_STEP;
-  const float GHOST_MAX = PAC_SPEED - 0.4f; if(gs>GHOST_MAX) gs=GHOST_MAX;
+  const float GHOST_MAX = PAC_SPEED - 0.4f;
+  return gs>GHOST_MAX ? GHOST_MAX : gs;
+}
+
+void steerGhost(World& w,int i){
+  const LevelHeader& lv = *levelOf(w).hdr;
+  Actor& g = w.ghosts[i];
+  int r=yToRow(g.y); int c=xToCol(g.x);
+  if(w.gDx[i]!=0) g.y = cellCenterY(r);
+  if(w.gDy[i]!=0) g.x = cellCenterX(c);
+  // Corridor cell entered from one exit: the other is the only non-reversing
+  // move and, on a connected level, the one the chase would pick. Straight
+  // runs change nothing; corners turn at the center without asking the AI.
+  int cell=r*COLS+c; unsigned back=1u<<(dirIndex(w.gDx[i],w.gDy[i])^1);
+  if(lv.ghostConnected && lv.junctionId[cell]<0 && (lv.ghostMask[cell] & back)){
+    int k=ctz64(lv.ghostMask[cell] & ~back);
+    if((DIR_DX[k]!=w.gDx[i] || DIR_DY[k]!=w.gDy[i]) && atCellCenter(g.x, g.y, r, c)){ w.gDx[i]=DIR_DX[k]; w.gDy[i]=DIR_DY[k]; }
+  }
+  else if(atCellCenter(g.x, g.y, r, c)){
+    chooseGhostDirWithChase(w,i,r,c);
+    int nr,nc; worldToNextCell(r,c,w.gDx[i],w.gDy[i],nr,nc);
+    if(blockedForGhostCell(w,nr,nc)){ w.gDx[i]=w.gDy[i]=0; }
+  }
+}
+
+// Fixed steps look on every tick inside a window and the last look before
+// leaving it sticks, so a swept move stops just inside both of its ends
+static constexpr float LOOK_EPS = 1e-4f;
+static constexpr float LOOK_AT  = CENTER_EPS - LOOK_EPS;
+
+// How far ghost i moves before steerGhost() has something new to look at: it
+// enters, or is about to leave, the atCellCenter() window of a corner or
+// junction (straight corridor cells pass by). Huge while it stands still.
+static float ghostLookDistance(const World& w,int i){
+  int k = dirIndex(w.gDx[i], w.gDy[i]); if(k==DIR_NONE) return 1e30f;
+  const LevelHeader& lv = *levelOf(w).hdr;
+  const Actor& g = w.ghosts[i];
+  int r=yToRow(g.y), c=xToCol(g.x);
+  float a = pastCenter(g, DIR_DX[k], DIR_DY[k]);
+  if(a < -LOOK_AT) return -a - LOOK_AT + LOOK_EPS;
+  if(a < LOOK_AT - 2*LOOK_EPS) return LOOK_AT - LOOK_EPS - a;
+  float d = 1.0f - a - LOOK_AT + LOOK_EPS; r -= DIR_DY[k]; c += DIR_DX[k];
+  const unsigned straight = (1u<<k) | (1u<<(k^1));
+  while(lv.ghostConnected && r>=0 && r<ROWS && c>=0 && c<COLS && lv.ghostMask[r*COLS+c]==straight && lv.junctionId[r*COLS+c]<0){
+    d += 1.0f; r -= DIR_DY[k]; c += DIR_DX[k];
+  }
+  return d;
+}
+
+// Pac-Man's move this step: a straight line at PAC_SPEED from (x0,y0) to
+// (x1,y1), reached at t1 (before the step ends if a wall stopped him)
+struct PacPath {
+  float x0,y0,x1,y1,t1;
+  void at(float t, float& x, float& y) const {
+    if(t>=t1){ x=x1; y=y1; }
+    else if(t<=0.0f){ x=x0; y=y0; }
+    else { x=x0+(x1-x0)*(t/t1); y=y0+(y1-y0)*(t/t1); }
+  }
+};
+
+// Does a ghost going from (ax,ay) at time ta to (bx,by) at tb come within rr
+// of Pac-Man? closing: how fast the two can approach each other, cells/s
+static bool ghostMeetsPac(const PacPath& p, float ta, float ax, float ay, float tb, float bx, float by, float rr, float closing){
+  float px,py; p.at(tb, px, py); float x1=bx-px, y1=by-py;
+  if(x1*x1 + y1*y1 < rr*rr) return true;
+  // Closing less than a window's width, a pass can only graze under 0.003
+  // cells deep: the end-point test is as good and fixed steps stay cheap
+  if((tb-ta)*closing < 2*CENTER_EPS) return false;
+  if(ta<p.t1 && p.t1<tb){   // relative motion bends where Pac-Man stopped
+    float f=(p.t1-ta)/(tb-ta), mx=ax+(bx-ax)*f, my=ay+(by-ay)*f;
+    return ghostMeetsPac(p, ta, ax, ay, p.t1, mx, my, rr, closing) || ghostMeetsPac(p, p.t1, mx, my, tb, bx, by, rr, closing);
+  }
+  p.at(ta, px, py); float x0=ax-px, y0=ay-py;
+  if(x0*x1>0.0f && std::min(std::fabs(x0),std::fabs(x1))>=rr) return false;   // apart along x all the way
+  if(y0*y1>0.0f && std::min(std::fabs(y0),std::fabs(y1))>=rr) return false;
+  return sweptDistSq(x0, y0, x1, y1, 0.0f, 0.0f) < rr*rr;
+}
+
+static void moveGhost(World& w,int i,float d){
+  Actor& g = w.ghosts[i];
+  g.x = clampf(g.x + w.gDx[i]*d, 0.5f, COLS-0.5f);
+  g.y = clampf(g.y + w.gDy[i]*d, 0.5f, ROWS-0.5f);
+}
 
+void updateGhosts(World& w, float dt, float pacFromX, float pacFromY){
+  PAC_PROFILE_SCOPE("updateGhosts");
+  float gs=ghostSpeed(nowSeconds(w.rt));
+  Actor* ghosts = w.ghosts; const Actor& pacman = w.pacman;
+  const float mx=pacman.x-pacFromX, my=pacman.y-pacFromY, moved=mx*mx+my*my;
+  const float pv=PAC_SPEED*PAC_SPEED*(pacman.vx*pacman.vx + pacman.vy*pacman.vy);
+  const PacPath path{pacFromX, pacFromY, pacman.x, pacman.y,
+                     moved >= 0.999f*pv*dt*dt ? dt : moved>0.0f && pv>0.0f ? std::sqrt(moved/pv) : 0.0f};  // full step, up to rounding
   for(int i=0;i<4;i++){
-    int r=yToRow(ghosts[i].y); int c=xToCol(ghosts[i].x);
-    if(gDx[i]!=0) ghosts[i].y = cellCenterY(r);
-    if(gDy[i]!=0) ghosts[i].x = cellCenterX(c);
-    if(atCellCenter(ghosts[i].x, ghosts[i].y, r, c)){
-      chooseGhostDirWithChase(i,r,c);
-      int nr,nc; worldToNextCell(r,c,gDx[i],gDy[i],nr,nc);
-      if(blockedForGhostCell(nr,nc)){ gDx[i]=gDy[i]=0; }
-    }
-    ghosts[i].x += gDx[i]*gs*dt; ghosts[i].y += gDy[i]*gs*dt;
-    ghosts[i].x = clampf(ghosts[i].x, 0.5f, COLS-0.5f);
-    ghosts[i].y = clampf(ghosts[i].y, 0.5f, ROWS-0.5f);
-    float dx=ghosts[i].x-pacman.x, dy=ghosts[i].y-pacman.y; float rr=(ghosts[i].radius+pacman.radius-0.04f);
-    if(dx*dx+dy*dy < rr*rr){ triggerDeath(rt); return; }
+    // A move long enough to jump a whole window goes in pieces, looking
+    // wherever shorter steps would have; shorter moves look once, as ever
+    float t=0.0f, left=gs*dt, rr=(ghosts[i].radius+pacman.radius-0.04f);
+    do{
+      steerGhost(w,i);
+      float d = left >= 2*CENTER_EPS ? std::min(left, ghostLookDistance(w,i)) : left;
+      float ax=ghosts[i].x, ay=ghosts[i].y, ta=t;
+      moveGhost(w, i, d);
+      left -= d; t = left>0.0f ? dt - left/gs : dt;
+      if(ghostMeetsPac(path, ta, ax, ay, t, ghosts[i].x, ghosts[i].y, rr, gs+PAC_SPEED)){ triggerDeath(w); return; }
+    }while(left>0.0f);
   }
 }
 
-// NOTE: This core module does not know about UI states/menus.
-// Callers should decide when to skip gameplay (e.g., when in menus or paused).
-void step(Runtime& rt){
-  using Clock = std::chrono::steady_clock;
-  auto now = Clock::now();
-  float dt = std::chrono::duration<float>(now - rt.tLast).count();
-  rt.tLast = now;
+void updateGhosts(World& w, float dt){ updateGhosts(w, dt, w.pacman.x, w.pacman.y); }
+
+// One tick of the rules, dt up to SIM_DT
+static void tick(World& w, float dt){
+  Runtime& rt = w.rt;
+  // The clock keeps running while paused so the game-over hold can elapse
+  rt.simTime += dt;
 
   // Death animation hold
   if(rt.deathActive){
-    float tSince = std::chrono::duration<float>(now - rt.tDeathStart).count();
-    if(tSince >= 1.0f) finalizeDeath(rt);
+    if(rt.simTime - rt.tDeathStart >= 1.0f) finalizeDeath(w);
     return;
   }
 
@@ -567,23 +3062,582 @@ void step(Runtime& rt){
   }
 
   // Normal updates
-  float elapsed=std::chrono::duration<float>(now - rt.tStart).count();
-  maybeSpawnSupers(rt, elapsed);
-  maybeSpawnHeart (rt, elapsed);
-  updatePac(rt, dt);
-  updateGhosts(rt, dt);
+  float elapsed=nowSeconds(rt);
+  maybeSpawnSupers(w, elapsed);
+  maybeSpawnHeart (w, elapsed);
+  const float pacX=w.pacman.x, pacY=w.pacman.y;
+  updatePac(w, dt);
+  updateGhosts(w, dt, pacX, pacY);
+}
+
+// NOTE: This core module does not know about UI states/menus.
+// Callers should decide when to skip gameplay (e.g., when in menus or paused).
+void step(World& w, float dt){
+  PAC_PROFILE_SCOPE("step");
+  // Longer steps are that many ticks, played by the event stepper: every
+  // contact, pellet, turn and spawn lands on the tick it would at SIM_DT, in
+  // that order. A fraction of a tick left over is one short tick.
+  if(dt > SIM_DT*(1.0f + 1e-3f)){
+    const int ticks = (int)(dt/SIM_DT + 1e-3f);
+    for(float left=ticks*SIM_DT; left>0.5f*SIM_DT; ) left -= stepToNextEvent(w, left);
+    dt -= ticks*SIM_DT;
+    if(dt <= 1e-3f*SIM_DT) return;
+  }
+  tick(w, dt);
+}
+
+void coast(World& w, int ticks){
+  Runtime& rt = w.rt;
+  if(ticks<=0) return;
+  const float d = ghostSpeed(nowSeconds(rt) + SIM_DT)*SIM_DT;   // no step-up inside, see above
+  for(int j=0;j<ticks;j++) rt.simTime += SIM_DT;
+  if(rt.deathActive || rt.paused) return;
+  for(int j=0;j<ticks;j++) movePac(w, SIM_DT);
+  for(int i=0;i<4;i++) for(int j=0;j<ticks;j++) moveGhost(w, i, d);
 }
 
-void startNewGame(Runtime& rt){
+void startNewGame(World& w){
+  Runtime& rt = w.rt;
   rt.paused=false; rt.gameOver=false; rt.winGame=false; rt.deathActive=false;
   rt.score=0; rt.pelletsEaten=0; rt.lives=3; rt.postMenuShown=false;
-  copyMazeFromTemplate();
-  rt.pelletsTotal = countDots();
-  resetActors(rt);
-  initGhostDirsRandom();
-  resetSupers(rt);
-  resetHeart(rt);
-  rt.tStart = rt.tLast = std::chrono::steady_clock::now();
+  copyMazeFromTemplate(w);
+  rt.pelletsTotal = levelOf(w).hdr->pelletCount;
+  resetActors(w);
+  initGhostDirsRandom(w);
+  resetSupers(w);
+  resetHeart(w);
+  rt.simTime = rt.tDeathStart = rt.tGameOverAt = 0.0f;
+}
+
+void applyInput(World& w, InputCode in){
+  Runtime& rt = w.rt; Actor& pacman = w.pacman;
+  if(in==IN_NEW_GAME){ startNewGame(w); return; }
+  if(rt.gameOver || rt.winGame || rt.deathActive) return;
+  switch(in){
+    case IN_UP:    pacman.vx=0;  pacman.vy=+1; rt.pacAngleDeg =  90.0f; break;
+    case IN_DOWN:  pacman.vx=0;  pacman.vy=-1; rt.pacAngleDeg = -90.0f; break;
+    case IN_LEFT:  pacman.vx=-1; pacman.vy=0;  rt.pacAngleDeg = 180.0f; break;
+    case IN_RIGHT: pacman.vx=+1; pacman.vy=0;  rt.pacAngleDeg =   0.0f; break;
+    case IN_PAUSE: rt.paused=!rt.paused; break;
+    default: break;
+  }
+}
+
+bool finishGameOverHold(World& w){
+  Runtime& rt = w.rt;
+  if(!rt.gameOver || rt.postMenuShown || rt.simTime - rt.tGameOverAt < GAME_OVER_HOLD_S) return false;
+  rt.postMenuShown = true;
+  return true;
 }
 
 } // namespace pac
+
+
+// =============================
+// File: src/headless.cpp
+// =============================
+// Headless batch driver: plays whole games on the simulated clock with a
+// random-walk autopilot, no window or GL context needed. Games run in
+// parallel on a BatchRunner; game g is seeded with seed+g, so results do
+// not depend on the thread count. With a level pack, game g plays the pack's
+// level g % count instead of the built-in maze. --events advances with
+// next-event stepping (events.hpp) instead of fixed SIM_DT ticks. --greedy
+// plays the pellet-greedy autopilot instead of the random walk. --compare plays
+// every game both ways and prints per-game scores, end times and position drift;
+// it exits 1 unless every game came out identical.
+// Usage: pac_headless [--events] [--greedy] [--compare] [games=100] [seed=1] [threads=0 (all cores)] [pack.pacl]
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "autopilot.hpp"
+#include "batch.hpp"
+#include "events.hpp"
+#include "level.hpp"
+#include "logic.hpp"
+#include "util.hpp"
+
+using namespace pac;
+
+// Cap per game so a pathological autopilot can't spin forever
+static constexpr float MAX_GAME_S = 600.0f;
+// Simulated ticks per batch call (one simulated second at SIM_DT)
+static constexpr int TICKS_PER_CALL = 120;
+
+// --compare lines the two runs up every CHECK_S of simulated time
+static constexpr float CHECK_S = 0.1f;
+
+static bool ended(const World& w){ return w.rt.gameOver || w.rt.winGame; }
+
+static float drift(const World& a, const World& b){
+  float d = std::hypot(a.pacman.x-b.pacman.x, a.pacman.y-b.pacman.y);
+  for(int i=0;i<4;i++) d = std::max(d, std::hypot(a.ghosts[i].x-b.ghosts[i].x, a.ghosts[i].y-b.ghosts[i].y));
+  return d;
+}
+
+struct Compare {
+  World fixed, event;
+  long long ticks=0, events=0;
+  float maxDrift=0.0f;   // cells, largest actor distance at a checkpoint
+};
+struct CompareJob { Compare* games; WorldPolicy policy; };
+
+// Fixed ticks lead by up to one tick; the event run then catches up to the same instant
+static void compareChunk(void* ctx, std::size_t b, std::size_t e){
+  CompareJob& job = *static_cast<CompareJob*>(ctx);
+  for(std::size_t g=b; g<e; g++){
+    Compare& c = job.games[g]; World& f = c.fixed; World& v = c.event;
+    for(float until=CHECK_S; !(ended(f) && ended(v)) && until<MAX_GAME_S; until+=CHECK_S){
+      while(!ended(f) && f.rt.simTime<until){ job.policy(f); step(f, SIM_DT); c.ticks++; }
+      float left = (ended(f) ? until : f.rt.simTime) - v.rt.simTime;
+      while(!ended(v) && left>0.5f*SIM_DT){ job.policy(v); left -= stepToNextEvent(v, left); c.events++; }
+      if(!ended(f) && !ended(v)) c.maxDrift = std::max(c.maxDrift, drift(f, v));
+    }
+  }
+}
+
+int main(int argc,char** argv){
+  bool events = false, greedy = false, compare = false; std::vector<const char*> args;
+  for(int i=1;i<argc;i++){
+    if(std::strcmp(argv[i],"--events")==0) events = true;
+    else if(std::strcmp(argv[i],"--greedy")==0) greedy = true;
+    else if(std::strcmp(argv[i],"--compare")==0) compare = true;
+    else args.push_back(argv[i]);
+  }
+  const WorldPolicy policy = greedy ? autopilotGreedy : autopilotRandomWalk;
+  const int nargs = (int)args.size();
+  int games = nargs>0 ? std::atoi(args[0]) : 100;
+  unsigned long long seed = nargs>1 ? std::strtoull(args[1],nullptr,10) : 1ull;
+  int threads = nargs>2 ? std::atoi(args[2]) : 0;
+  if(games<1) games=1;
+  int firstLevel = 0, levels = 1;
+  if(nargs>3){
+    firstLevel = loadLevelPack(args[3]);
+    if(firstLevel<0){ std::fprintf(stderr,"pac_headless: %s is not a level pack\n",args[3]); return 1; }
+    levels = levelCount()-firstLevel;
+  }
+
+  std::vector<World> worlds(games);
+  for(int g=0; g<games; ++g){
+    World& w = worlds[g];
+    seedRng(w, seed+(unsigned long long)g); w.level = (uint16_t)(firstLevel + g%levels);
+    startNewGame(w);
+  }
+
+  BatchRunner runner(threads);
+  if(compare){
+    std::vector<Compare> runs(worlds.size());
+    for(std::size_t g=0; g<runs.size(); g++) runs[g].fixed = runs[g].event = worlds[g];
+    CompareJob job{runs.data(), policy};
+    runner.parallelFor(runs.size(), 1, compareChunk, &job);
+    int same=0; float maxDrift=0.0f; long long ticks=0, evts=0;
+    for(std::size_t g=0; g<runs.size(); g++){
+      const Compare& c = runs[g];
+      std::printf("game %zu: score %d/%d end %.3fs/%.3fs steps %lld/%lld max-drift %.4f\n",
+                  g, c.fixed.rt.score, c.event.rt.score, c.fixed.rt.simTime, c.event.rt.simTime,
+                  c.ticks, c.events, c.maxDrift);
+      same += c.fixed.rt.score==c.event.rt.score && c.fixed.rt.simTime==c.event.rt.simTime && c.maxDrift==0.0f;
+      maxDrift = std::max(maxDrift, c.maxDrift); ticks += c.ticks; evts += c.events;
+    }
+    std::printf("compare games=%d seed=%llu policy=%s identical=%d max-drift=%.4f ticks=%lld events=%lld\n",
+                games, seed, greedy ? "greedy" : "random", same, maxDrift, ticks, evts);
+    return same==games ? 0 : 1;
+  }
+
+  // All unfinished worlds advance in lockstep, so one clock bounds them all
+  BatchStats total; float simClock=0.0f; int finished=0;
+  while(finished<games && simClock<MAX_GAME_S){
+    BatchStats st = events ? runner.stepEvents(worlds.data(), worlds.size(), TICKS_PER_CALL*SIM_DT, policy)
+                           : runner.step(worlds.data(), worlds.size(), SIM_DT, TICKS_PER_CALL, policy);
+    total.worldTicks += st.worldTicks; total.wallSeconds += st.wallSeconds;
+    finished += st.gamesFinished; simClock += TICKS_PER_CALL*SIM_DT;
+  }
+  total.gamesFinished = finished;
+
+  long long scoreSum=0; int wins=0; double simSecs=0.0;
+  for(const World& w:worlds){ scoreSum += w.rt.score; wins += w.rt.winGame; simSecs += w.rt.simTime; }
+
+  std::printf("games=%d seed=%llu threads=%d wins=%d scoreSum=%lld %s=%lld\n",
+              games, seed, runner.threadCount(), wins, scoreSum, events ? "events" : "ticks", total.worldTicks);
+  std::printf("sim=%.1fs wall=%.3fs speedup=%.0fx games/s=%.0f ticks/s=%.0f\n",
+              simSecs, total.wallSeconds, total.wallSeconds>0.0 ? simSecs/total.wallSeconds : 0.0,
+              total.gamesPerSec(), total.ticksPerSec());
+  return 0;
+}
+
+
+// =============================
+// File: src/replayer.cpp
+// =============================
+// Replay driver: re-runs sessions recorded with `pacman --record FILE` at full
+// speed without a window, many sessions in parallel on a BatchRunner. Prints
+// one line per session (final score and world digest) so two builds can be
+// diffed, plus overall throughput. Files may hold any number of sessions.
+// Sessions on pack levels need the same packs, given in the same order as
+// when they were recorded.
+// Usage: pac_replay [--mmap] [--threads N] [--quiet] [--levels PACK]... log...
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "batch.hpp"
+#include "level.hpp"
+#include "mapfile.hpp"
+#include "replay.hpp"
+
+using namespace pac;
+
+struct Job { const ReplaySession* sessions; ReplayResult* results; };
+
+static void replayRange(void* ctx, std::size_t b, std::size_t e){
+  Job& job = *(Job*)ctx;
+  for(std::size_t i=b;i<e;i++) job.results[i] = runReplay(job.sessions[i]);
+}
+
+int main(int argc,char** argv){
+  bool useMmap=false, quiet=false; int threads=0;
+  std::vector<const char*> paths;
+  for(int i=1;i<argc;i++){
+    if(std::strcmp(argv[i],"--mmap")==0) useMmap=true;
+    else if(std::strcmp(argv[i],"--quiet")==0) quiet=true;
+    else if(std::strcmp(argv[i],"--threads")==0 && i+1<argc) threads=std::atoi(argv[++i]);
+    else if(std::strcmp(argv[i],"--levels")==0 && i+1<argc){
+      if(loadLevelPack(argv[++i])<0){ std::fprintf(stderr,"pac_replay: %s is not a level pack\n",argv[i]); return 1; }
+    }
+    else paths.push_back(argv[i]);
+  }
+  if(paths.empty()){ std::fprintf(stderr,"usage: pac_replay [--mmap] [--threads N] [--quiet] [--levels PACK]... log...\n"); return 2; }
+
+  std::vector<std::unique_ptr<MappedFile>> files;
+  std::vector<ReplaySession> sessions; std::vector<int> fileOf;
+  for(std::size_t f=0; f<paths.size(); f++){
+    files.emplace_back(new MappedFile);
+    if(!files.back()->open(paths[f], useMmap, true)){ std::fprintf(stderr,"pac_replay: cannot read %s\n",paths[f]); return 1; }
+    std::size_t before = sessions.size();
+    if(!splitSessions(files.back()->data(), files.back()->size(), sessions))
+      std::fprintf(stderr,"pac_replay: %s: truncated or not an input log, kept %zu session(s)\n",paths[f],sessions.size()-before);
+    fileOf.resize(sessions.size(), (int)f);
+  }
+
+  std::vector<ReplayResult> results(sessions.size());
+  BatchRunner runner(threads);
+  auto t0 = std::chrono::steady_clock::now();
+  Job job{sessions.data(), results.data()};
+  runner.parallelFor(sessions.size(), 1, replayRange, &job);
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+
+  unsigned long long ticks=0; int bad=0;
+  for(std::size_t i=0;i<sessions.size();i++){
+    const ReplayResult& r = results[i];
+    ticks += r.ticks; bad += !r.ok;
+    if(!quiet)
+      std::printf("%s#%zu seed=%llu games=%d ticks=%llu score=%d lives=%d digest=%016llx%s\n",
+                  paths[fileOf[i]], i, (unsigned long long)sessions[i].seed, r.games, (unsigned long long)r.ticks,
+                  r.score, r.lives, (unsigned long long)r.digest, r.ok ? "" : " DESYNC");
+  }
+  std::printf("sessions=%zu bad=%d threads=%d ticks=%llu wall=%.3fs ticks/s=%.0f sessions/s=%.0f\n",
+              sessions.size(), bad, runner.threadCount(), ticks, wall,
+              wall>0.0 ? ticks/wall : 0.0, wall>0.0 ? sessions.size()/wall : 0.0);
+  return bad ? 1 : 0;
+}
+
+
+// =============================
+// File: src/vecenv_run.cpp
+// =============================
+// VecEnv driver: steps N environments with random actions and reports
+// throughput plus a checksum over rewards and final observations, which must
+// not change with the thread count. --swept advances each action as one
+// coarse step instead of separate SIM_DT ticks; --ticks sets the ticks per
+// action (default 4). --compare runs both side by side on the same actions and
+// exits 1 unless every env has the same reward, done flag and state after
+// every action.
+// Usage: pac_vecenv [--swept|--compare] [--ticks n] [envs=256] [steps=1000] [seed=1] [threads=0 (all cores)]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "vecenv.hpp"
+#include "rng.hpp"
+
+using namespace pac;
+
+// Everything play depends on. The clocks may differ: a coarse step keeps
+// counting paused ticks after a game ends where the tick loop stops.
+static bool sameState(const World& a, const World& b){
+  auto same = [](const Actor& p, const Actor& q){ return p.x==q.x && p.y==q.y && p.vx==q.vx && p.vy==q.vy; };
+  if(!same(a.pacman, b.pacman) || !(a.pellets==b.pellets) || a.rt.score!=b.rt.score || a.rt.lives!=b.rt.lives) return false;
+  for(int i=0;i<4;i++) if(!same(a.ghosts[i], b.ghosts[i]) || a.gDx[i]!=b.gDx[i] || a.gDy[i]!=b.gDy[i]) return false;
+  return true;
+}
+
+static int compare(int envs, int steps, int ticks, unsigned long long seed, int threads){
+  VecEnv fine((std::size_t)envs, threads, ticks, 0, false), coarse((std::size_t)envs, threads, ticks, 0, true);
+  std::vector<float> obsF((std::size_t)envs*OBS_SIZE), obsC(obsF.size()), rewardF(envs), rewardC(envs);
+  std::vector<uint8_t> actions(envs), doneF(envs), doneC(envs);
+  Pcg32 pick; pcgSeed(pick, seed, 1);
+  fine.reset(seed, obsF.data()); coarse.reset(seed, obsC.data());
+  long long differ=0; double score=0.0;
+  for(int s=0;s<steps;s++){
+    for(uint8_t& a : actions) a = (uint8_t)pcgBelow(pick, ACT_COUNT);
+    fine.step(actions.data(), obsF.data(), rewardF.data(), doneF.data());
+    coarse.step(actions.data(), obsC.data(), rewardC.data(), doneC.data());
+    for(int i=0;i<envs;i++){
+      score += rewardF[i];
+      if(rewardF[i]==rewardC[i] && doneF[i]==doneC[i] && sameState(fine.world(i), coarse.world(i))) continue;
+      if(differ++==0) std::printf("env %d step %d: reward %.0f/%.0f done %d/%d score %d/%d\n", i, s, rewardF[i], rewardC[i],
+                                  doneF[i], doneC[i], fine.world(i).rt.score, coarse.world(i).rt.score);
+    }
+  }
+  std::printf("compare envs=%d steps=%d ticks=%d seed=%llu reward=%.0f differing=%lld\n", envs, steps, ticks, seed, score, differ);
+  return differ ? 1 : 0;
+}
+
+int main(int argc,char** argv){
+  bool swept = false, cmp = false; int ticks = 4; std::vector<const char*> args;
+  for(int i=1;i<argc;i++){
+    if(std::strcmp(argv[i],"--swept")==0) swept = true;
+    else if(std::strcmp(argv[i],"--compare")==0) cmp = true;
+    else if(std::strcmp(argv[i],"--ticks")==0 && i+1<argc) ticks = std::max(1, std::atoi(argv[++i]));
+    else args.push_back(argv[i]);
+  }
+  int n = (int)args.size();
+  int envs  = n>0 ? std::atoi(args[0]) : 256;
+  int steps = n>1 ? std::atoi(args[1]) : 1000;
+  unsigned long long seed = n>2 ? std::strtoull(args[2],nullptr,10) : 1ull;
+  int threads = n>3 ? std::atoi(args[3]) : 0;
+  if(envs<1) envs=1;
+  if(cmp) return compare(envs, steps, ticks, seed, threads);
+
+  VecEnv env((std::size_t)envs, threads, ticks, 0, swept);
+  std::vector<float> obs((std::size_t)envs*OBS_SIZE), reward(envs);
+  std::vector<uint8_t> actions(envs), done(envs);
+  Pcg32 pick; pcgSeed(pick, seed, 1);   // actions get their own stream
+
+  env.reset(seed, obs.data());
+  double rewardSum=0.0; long long episodes=0;
+  auto t0 = std::chrono::steady_clock::now();
+  for(int s=0;s<steps;s++){
+    for(uint8_t& a : actions) a = (uint8_t)pcgBelow(pick, ACT_COUNT);
+    env.step(actions.data(), obs.data(), reward.data(), done.data());
+    for(int i=0;i<envs;i++){ rewardSum += reward[i]; episodes += done[i]; }
+  }
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  uint64_t h = 1469598103934665603ull;   // FNV-1a over the final observations
+  for(float f : obs){ h ^= (uint64_t)(f!=0.0f); h *= 1099511628211ull; }
+  std::printf("envs=%d steps=%d seed=%llu threads=%d episodes=%lld reward=%.0f obs=%016llx\n",
+              envs, steps, seed, threads, episodes, rewardSum, (unsigned long long)h);
+  std::printf("wall=%.3fs env-steps/s=%.0f\n", wall, wall>0.0 ? (double)envs*steps/wall : 0.0);
+  return 0;
+}
+
+
+// =============================
+// File: src/soak.cpp
+// =============================
+// Soak driver for runtime-sized mazes: generates a ChunkedMaze and runs the
+// BigSim autopilot on the simulated clock. ticks/s should not depend on the
+// maze size, only on the ghosts awake around Pac-Man.
+// Usage: pac_soak [rows=4096] [cols=rows] [seconds=600] [seed=1]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "bigmaze.hpp"
+#include "config.hpp"
+
+using namespace pac;
+using Clock = std::chrono::steady_clock;
+
+int main(int argc,char** argv){
+  int rows = argc>1 ? std::atoi(argv[1]) : 4096;
+  int cols = argc>2 ? std::atoi(argv[2]) : rows;
+  float seconds = argc>3 ? (float)std::atof(argv[3]) : 600.0f;
+  unsigned long long seed = argc>4 ? std::strtoull(argv[4],nullptr,10) : 1ull;
+
+  BigSim sim;
+  auto t0=Clock::now();
+  sim.reset(rows, cols, seed);
+  double genS=std::chrono::duration<double>(Clock::now()-t0).count();
+  const ChunkedMaze& m=sim.maze();
+  std::printf("maze %dx%d chunks=%dx%d (%.1f MiB) pellets=%lld ghosts=%zu generated in %.3fs\n",
+              m.rows(), m.cols(), m.chunkRows(), m.chunkCols(), m.bytes()/1048576.0, m.pelletsLeft(), sim.ghostCount(), genS);
+
+  long long ticks=(long long)(seconds/SIM_DT), active=0;
+  t0=Clock::now();
+  for(long long t=0;t<ticks;t++){ sim.step(SIM_DT); active+=sim.activeGhosts; }
+  double runS=std::chrono::duration<double>(Clock::now()-t0).count();
+  std::printf("sim=%.0fs ticks=%lld wall=%.3fs ticks/s=%.0f awake ghosts=%.1f score=%lld catches=%lld at (%d,%d)\n",
+              seconds, ticks, runS, runS>0.0 ? ticks/runS : 0.0, ticks ? (double)active/ticks : 0.0, sim.score, sim.catches, sim.pacman().r, sim.pacman().c);
+  return 0;
+}
+
+
+// =============================
+// File: src/levelpack.cpp
+// =============================
+// Level pack tool: writes .pacl packs (level.hpp) and inspects them.
+//   pac_levels build out.pacl [levels=100] [seed=1]
+//     level 0 is the built-in maze; the others are variants of it with inner
+//     walls opened or closed at random, every pellet still reachable from
+//     Pac-Man's start and the ghost house left as it is
+//   pac_levels info pack.pacl [--read]
+//     times opening the pack (mapped, or read with --read) against rebuilding
+//     the same levels from their bit planes, then lists them
+//   pac_levels check scratch.pacl
+//     writes packs with one field of level 0 corrupted (flipped mask bytes,
+//     out-of-range ids, a wrong pellet count...) and fails unless every one is
+//     refused at load while the intact pack loads
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "level.hpp"
+#include "maze.hpp"
+#include "rng.hpp"
+
+using namespace pac;
+
+using Clock = std::chrono::steady_clock;
+static double msSince(Clock::time_point t0){ return std::chrono::duration<double,std::milli>(Clock::now()-t0).count(); }
+
+static constexpr int START_ROW = 5, START_COL = 9;   // Pac-Man's start cell (World::pacman)
+
+// Border, the three HUD rows and the ghost house stay as in the template
+static bool editable(int r,int c){
+  if(r<1 || r>=ROWS-3 || c<1 || c>=COLS-1) return false;
+  if(r>=8 && r<=11 && c>=7 && c<=11) return false;
+  return !(r==START_ROW && c==START_COL);
+}
+
+// Every DOTCELL reachable by Pac-Man from his start cell
+static bool allPelletsReachable(const int maze[ROWS][COLS]){
+  bool seen[ROWS][COLS] = {};
+  int queue[BOARD_CELLS]; int head=0, tail=0;
+  queue[tail++] = START_ROW*COLS+START_COL; seen[START_ROW][START_COL] = true;
+  while(head<tail){
+    int r=queue[head]/COLS, c=queue[head]%COLS; head++;
+    for(int d=0; d<4; d++){
+      int nr=r-DIR_DY[d], nc=c+DIR_DX[d];
+      if(nr<0||nr>=ROWS||nc<0||nc>=COLS || seen[nr][nc] || maze[nr][nc]==WALL || maze[nr][nc]==GATE) continue;
+      seen[nr][nc] = true; queue[tail++] = nr*COLS+nc;
+    }
+  }
+  for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++) if(maze[r][c]==DOTCELL && !seen[r][c]) return false;
+  return true;
+}
+
+static void makeVariant(int maze[ROWS][COLS], uint64_t seed, uint64_t k){
+  std::memcpy(maze, MAZE_TEMPLATE, sizeof(MAZE_TEMPLATE));
+  Pcg32 g; pcgSeed(g, seed, k);
+  int flips = 8 + (int)pcgBelow(g, 17);
+  for(int tries=0; tries<1000 && flips>0; tries++){
+    int r = 1 + (int)pcgBelow(g, ROWS-4), c = 1 + (int)pcgBelow(g, COLS-2);
+    if(!editable(r,c)) continue;
+    int was = maze[r][c];
+    maze[r][c] = was==WALL ? DOTCELL : WALL;
+    if(allPelletsReachable(maze)) flips--; else maze[r][c] = was;
+  }
+}
+
+static int build(const char* path, int count, uint64_t seed){
+  std::vector<std::vector<uint8_t>> records(count);
+  auto t0 = Clock::now();
+  buildLevel(MAZE_TEMPLATE, "classic", records[0]);
+  for(int k=1; k<count; k++){
+    int maze[ROWS][COLS]; makeVariant(maze, seed, (uint64_t)k);
+    char name[32]; std::snprintf(name, sizeof(name), "variant-%d", k);
+    buildLevel(maze, name, records[k]);
+  }
+  double buildMs = msSince(t0);
+  if(!writeLevelPack(path, records)){ std::fprintf(stderr,"pac_levels: cannot write %s\n", path); return 1; }
+  std::size_t bytes=0; for(const auto& r : records) bytes += r.size();
+  std::printf("wrote %s: levels=%d bytes=%zu build=%.1fms\n", path, count, bytes, buildMs);
+  return 0;
+}
+
+static int info(const char* path, bool useMmap){
+  auto t0 = Clock::now();
+  int first = loadLevelPack(path, useMmap);
+  double openMs = msSince(t0);
+  if(first<0){ std::fprintf(stderr,"pac_levels: %s is not a level pack\n", path); return 1; }
+  int count = levelCount()-first;
+
+  // What loading saves: the tables rebuilt from each level's planes
+  t0 = Clock::now();
+  std::vector<uint8_t> scratch;
+  for(int i=first; i<levelCount(); i++){
+    const MazePlanes& p = level(i).planes();
+    int maze[ROWS][COLS];
+    for(int r=0;r<ROWS;r++) for(int c=0;c<COLS;c++)
+      maze[r][c] = p.walls.test(r,c) ? WALL : p.gates.test(r,c) ? GATE : p.pellets0.test(r,c) ? DOTCELL : EMPTY;
+    buildLevel(maze, level(i).hdr->name, scratch);
+  }
+  double rebuildMs = msSince(t0);
+
+  std::printf("%s: levels=%d open=%.3fms (%s) rebuild=%.1fms\n", path, count, openMs, useMmap ? "mmap" : "read", rebuildMs);
+  for(int i=first; i<levelCount() && i<first+10; i++){
+    const LevelHeader& h = *level(i).hdr;
+    std::printf("  #%d %-15s pellets=%d cells=%d junctions=%d spawn=%d bytes=%u\n", i-first, h.name, h.pelletCount, h.nCells, h.junctionCount, h.spawnCount, h.bytes);
+  }
+  if(count>10) std::printf("  ... %d more\n", count-10);
+  return 0;
+}
+
+static int check(const char* path){
+  std::vector<uint8_t> intact; buildLevel(MAZE_TEMPLATE, "classic", intact);
+  const LevelHeader& ref = *(const LevelHeader*)intact.data();
+  int open=-1, corridor=-1;   // an open cell with a wall next to it, a ghost corridor cell
+  for(int i=0;i<BOARD_CELLS;i++){
+    if(open<0 && ref.nbrMask[i] && ref.nbrMask[i]!=15) open=i;
+    if(corridor<0 && ref.ghostMask[i] && ref.junctionId[i]<0) corridor=i;
+  }
+  struct Case { const char* name; void (*apply)(LevelHeader&, int open, int corridor); };
+  static const Case cases[] = {
+    {"nbrMask bit 5",          [](LevelHeader& h,int o,int){ h.nbrMask[o] ^= 0x20; }},
+    {"nbrMask into a wall",    [](LevelHeader& h,int o,int){ h.nbrMask[o] |= (uint8_t)(~h.nbrMask[o] & (~h.nbrMask[o]+1) & 15); }},
+    {"ghostMask byte flipped", [](LevelHeader& h,int,int c){ h.ghostMask[c] ^= 0xFF; }},
+    {"ghostMask corridor bit", [](LevelHeader& h,int,int c){ h.ghostMask[c] &= (uint8_t)(h.ghostMask[c]-1); }},
+    {"junctionId on corridor", [](LevelHeader& h,int,int c){ h.junctionId[c] = 0; }},
+    {"pathIndex past nCells",  [](LevelHeader& h,int o,int){ h.pathIndex[o] = (int16_t)h.nCells; }},
+    {"run arrive 4",           [](LevelHeader& h,int,int c){ h.runs[c*4].arrive = 4; }},
+    {"pelletCount + 1",        [](LevelHeader& h,int,int){ h.pelletCount++; }},
+    {"ghostConnected 2",       [](LevelHeader& h,int,int){ h.ghostConnected = 2; }},
+  };
+  int failed=0;
+  auto loads = [&](const std::vector<uint8_t>& record){
+    if(!writeLevelPack(path, {record})){ std::fprintf(stderr,"pac_levels: cannot write %s\n", path); std::exit(1); }
+    return loadLevelPack(path, true)>=0;
+  };
+  if(!loads(intact)){ std::printf("FAIL intact pack refused\n"); failed++; }
+  for(const Case& k : cases){
+    std::vector<uint8_t> record = intact;
+    k.apply(*(LevelHeader*)record.data(), open, corridor);
+    bool refused = !loads(record);
+    std::printf("%s %s\n", refused ? "ok  " : "FAIL", k.name);
+    failed += !refused;
+  }
+  std::remove(path);
+  std::printf("check: %d of %d corruptions refused\n", (int)(sizeof(cases)/sizeof(cases[0])) - failed, (int)(sizeof(cases)/sizeof(cases[0])));
+  return failed ? 1 : 0;
+}
+
+int main(int argc,char** argv){
+  if(argc>=3 && std::strcmp(argv[1],"build")==0){
+    int count = argc>3 ? std::atoi(argv[3]) : 100;
+    unsigned long long seed = argc>4 ? std::strtoull(argv[4],nullptr,10) : 1ull;
+    return build(argv[2], count<1 ? 1 : count>UINT16_MAX ? UINT16_MAX : count, seed);   // World::level is 16-bit
+  }
+  if(argc>=3 && std::strcmp(argv[1],"info")==0)
+    return info(argv[2], !(argc>3 && std::strcmp(argv[3],"--read")==0));
+  if(argc>=3 && std::strcmp(argv[1],"check")==0) return check(argv[2]);
+  std::fprintf(stderr,"usage: pac_levels build out.pacl [levels] [seed]\n       pac_levels info pack.pacl [--read]\n       pac_levels check scratch.pacl\n");
+  return 2;
+}